@@ -0,0 +1,164 @@
+#pragma once
+#include <lje_sdk.h>
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "../globals.hpp"
+
+// Generates lua_CFunctions from plain C++ functions. Arguments are read straight from
+// their stack slots with one API call each and results are pushed in place, without
+// gettop or popping the arguments first. Lua reads past the top as nil, so a binding
+// always reads its full, fixed arity.
+//
+//   static bool button(const char *label, Opt<float> w, Opt<float> h) { ... }
+//   lua->pushcclosure(L, bind<button>, 0);
+//
+// Functions return void, a single value or a std::tuple of values.
+namespace binding {
+
+// Optional argument, Default is used when it is missing or nil
+template<typename T, auto Default = T{}>
+struct Opt {
+  T value;
+  operator T() const { return value; }
+};
+
+// String with its Lua length, for ImGui calls taking a text range
+struct Str {
+  const char *data;
+  size_t len;
+  const char *end() const { return data + len; }
+};
+
+namespace detail {
+
+template<typename T>
+struct Arg;
+
+template<typename T>
+  requires std::is_arithmetic_v<T> && (!std::is_same_v<T, bool>)
+struct Arg<T> {
+  static T read(lua_State *L, int idx) { return static_cast<T>(g_api->lua->tonumber(L, idx)); }
+};
+
+template<>
+struct Arg<bool> {
+  static bool read(lua_State *L, int idx) { return g_api->lua->toboolean(L, idx); }
+};
+
+// Required strings read nil as "", ImGui doesn't take null labels
+template<>
+struct Arg<const char *> {
+  static const char *read(lua_State *L, int idx) {
+    const char *str = g_api->lua->tolstring(L, idx, nullptr);
+    return str ? str : "";
+  }
+};
+
+// Nil reads as ""
+template<>
+struct Arg<Str> {
+  static Str read(lua_State *L, int idx) {
+    size_t len = 0;
+    const char *str = g_api->lua->tolstring(L, idx, &len);
+    return str ? Str{str, len} : Str{"", 0};
+  }
+};
+
+// Nil reads as 0, false or null already, the type is only checked when that
+// differs from the default
+template<typename T, auto Default>
+struct Arg<Opt<T, Default>> {
+  static Opt<T, Default> read(lua_State *L, int idx) {
+    if constexpr (std::is_same_v<T, const char *>) {
+      const char *str = g_api->lua->tolstring(L, idx, nullptr);
+      return {str ? str : Default};
+    } else if constexpr (std::is_same_v<T, bool>) {
+      bool value = g_api->lua->toboolean(L, idx);
+      if constexpr (Default)
+        return {value || g_api->lua->type(L, idx) <= 0}; // LUA_TNONE or LUA_TNIL
+      return {value};
+    } else {
+      T value = static_cast<T>(g_api->lua->tonumber(L, idx));
+      if constexpr (Default != T{}) {
+        if (value == T{} && g_api->lua->type(L, idx) <= 0) // LUA_TNONE or LUA_TNIL
+          return {static_cast<T>(Default)};
+      }
+      return {value};
+    }
+  }
+};
+
+template<typename T>
+void push(lua_State *L, T value) {
+  if constexpr (std::is_same_v<T, bool>)
+    g_api->lua->pushboolean(L, value);
+  else if constexpr (std::is_same_v<T, const char *>)
+    g_api->lua->pushstring(L, value);
+  else
+    g_api->lua->pushnumber(L, static_cast<double>(value));
+}
+
+template<typename T>
+struct Results {
+  static constexpr int count = 1;
+  static void push(lua_State *L, const T &value) { detail::push(L, value); }
+};
+
+template<typename... Ts>
+struct Results<std::tuple<Ts...>> {
+  static constexpr int count = sizeof...(Ts);
+  static void push(lua_State *L, const std::tuple<Ts...> &values) {
+    std::apply([L](const auto &...value) { (detail::push(L, value), ...); }, values);
+  }
+};
+
+template<typename F>
+struct Signature;
+
+template<typename R, typename... Args>
+struct Signature<R (*)(Args...)> {
+  using Result = R;
+  using ArgTuple = std::tuple<std::decay_t<Args>...>;
+  static constexpr size_t arity = sizeof...(Args);
+};
+
+template<auto Fn, size_t... I>
+int call(lua_State *L, std::index_sequence<I...>) {
+  using Sig = Signature<decltype(Fn)>;
+  using R = typename Sig::Result;
+  // Braced init keeps the argument reads in stack order
+  using Args = typename Sig::ArgTuple;
+
+  if constexpr (std::is_void_v<R>) {
+    std::apply(Fn, Args{Arg<std::tuple_element_t<I, Args>>::read(L, static_cast<int>(I) + 1)...});
+    return 0;
+  } else {
+    R result = std::apply(Fn, Args{Arg<std::tuple_element_t<I, Args>>::read(L, static_cast<int>(I) + 1)...});
+    Results<R>::push(L, result);
+    return Results<R>::count;
+  }
+}
+
+} // namespace detail
+
+// Memory handed over from Lua: a lightuserdata, or a LuaJIT cdata array such as
+// ffi.new("uint8_t[?]", n). A cdata's address is its payload, which for an array is the
+// elements themselves; a pointer cdata would give the address of the pointer, so scripts
+// pass arrays. Null for anything else.
+inline void *to_pointer(lua_State *L, int idx) {
+  int type = g_api->lua->type(L, idx);
+  if (type == 2) // LUA_TLIGHTUSERDATA
+    return g_api->lua->tolightuserdata(L, idx);
+  if (type == 10) // LUA_TCDATA
+    return const_cast<void *>(g_api->lua->topointer(L, idx));
+  return nullptr;
+}
+
+template<auto Fn>
+int bind(lua_State *L) {
+  return detail::call<Fn>(L, std::make_index_sequence<detail::Signature<decltype(Fn)>::arity>{});
+}
+
+} // namespace binding
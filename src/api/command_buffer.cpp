@@ -0,0 +1,592 @@
+#include "command_buffer.hpp"
+#include "binding.hpp"
+#include "imgui_api.hpp"
+#include "../globals.hpp"
+#include "../overlay.hpp"
+#include <imgui.h>
+#include <cstring>
+
+namespace command_buffer {
+
+namespace {
+
+// Bounds-checked cursor over the buffer, a read past the end marks it as malformed
+struct Reader {
+  const uint8_t *p;
+  const uint8_t *end;
+  bool ok = true;
+
+  bool has(size_t n) {
+    if (ok && static_cast<size_t>(end - p) >= n)
+      return true;
+    ok = false;
+    return false;
+  }
+
+  uint8_t u8() { return has(1) ? *p++ : 0; }
+  bool b8() { return u8() != 0; }
+
+  float f32() {
+    float v = 0.0f;
+    if (has(4)) {
+      memcpy(&v, p, 4);
+      p += 4;
+    }
+    return v;
+  }
+
+  int i32() {
+    int32_t v = 0;
+    if (has(4)) {
+      memcpy(&v, p, 4);
+      p += 4;
+    }
+    return v;
+  }
+
+  // Points into the buffer, which carries the terminating NUL. The length is stored in
+  // len when given.
+  const char *str(size_t *out_len = nullptr) {
+    if (out_len)
+      *out_len = 0;
+    if (!has(2))
+      return "";
+    uint16_t len;
+    memcpy(&len, p, 2);
+    p += 2;
+    if (!has(static_cast<size_t>(len) + 1) || p[len] != '\0') {
+      ok = false;
+      return "";
+    }
+    auto s = reinterpret_cast<const char *>(p);
+    p += len + 1;
+    if (out_len)
+      *out_len = len;
+    return s;
+  }
+};
+
+struct Results {
+  lua_State *L;
+  int table = 0;          // Stack index of a results table, or 0
+  double *out = nullptr;  // Or a double array
+  size_t capacity = 0;
+  size_t count = 0;
+
+  void number(double v) {
+    if (table) {
+      g_api->lua->pushnumber(L, v);
+      g_api->lua->rawseti(L, table, static_cast<int>(count + 1));
+    } else if (out && count < capacity) {
+      out[count] = v;
+    }
+    count++;
+  }
+
+  void boolean(bool v) {
+    if (table) {
+      g_api->lua->pushboolean(L, v);
+      g_api->lua->rawseti(L, table, static_cast<int>(count + 1));
+    } else if (out && count < capacity) {
+      out[count] = v ? 1.0 : 0.0;
+    }
+    count++;
+  }
+
+  void skip(size_t n) { count += n; }
+};
+
+bool is_open(Op op) {
+  switch (op) {
+  case Op::BeginWindow:
+  case Op::BeginChild:
+  case Op::TreeNode:
+  case Op::CollapsingHeader:
+  case Op::BeginTabBar:
+  case Op::BeginTabItem:
+  case Op::BeginCombo:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool is_close(Op op) {
+  switch (op) {
+  case Op::EndWindow:
+  case Op::EndChild:
+  case Op::TreePop:
+  case Op::EndCollapsingHeader:
+  case Op::EndTabBar:
+  case Op::EndTabItem:
+  case Op::EndCombo:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Opening op a close (or PopId) has to match, Op::Count for other ops
+Op opener(Op op) {
+  switch (op) {
+  case Op::EndWindow: return Op::BeginWindow;
+  case Op::EndChild: return Op::BeginChild;
+  case Op::TreePop: return Op::TreeNode;
+  case Op::EndCollapsingHeader: return Op::CollapsingHeader;
+  case Op::EndTabBar: return Op::BeginTabBar;
+  case Op::EndTabItem: return Op::BeginTabItem;
+  case Op::EndCombo: return Op::BeginCombo;
+  case Op::PopId: return Op::PushId;
+  default: return Op::Count;
+  }
+}
+
+void close_scope(Op open) {
+  switch (open) {
+  case Op::BeginWindow: ImGui::End(); break;
+  case Op::BeginChild: ImGui::EndChild(); break;
+  case Op::TreeNode: ImGui::TreePop(); break;
+  case Op::BeginTabBar: ImGui::EndTabBar(); break;
+  case Op::BeginTabItem: ImGui::EndTabItem(); break;
+  case Op::BeginCombo: ImGui::EndCombo(); break;
+  case Op::PushId: ImGui::PopID(); break;
+  default: break; // CollapsingHeader has nothing to close
+  }
+}
+
+// Scopes the buffer opened on ImGui's stacks. Closes have to match the innermost one, and
+// whatever is still open when the buffer ends or breaks off is closed in reverse, so a bad
+// buffer never leaves ImGui's stacks unbalanced.
+struct Scopes {
+  static constexpr int MAX_DEPTH = 64;
+  Op ops[MAX_DEPTH];
+  int depth = 0;
+
+  bool push(Op open) {
+    if (depth == MAX_DEPTH)
+      return false;
+    ops[depth++] = open;
+    return true;
+  }
+
+  bool pop(Op open) {
+    if (depth == 0 || ops[depth - 1] != open)
+      return false;
+    depth--;
+    close_scope(open);
+    return true;
+  }
+
+  void unwind() {
+    while (depth > 0)
+      close_scope(ops[--depth]);
+  }
+};
+
+// Interprets the buffer. Arguments are always decoded to advance the cursor, widgets only
+// run while nothing is being skipped.
+bool run(Reader &r, Results &results) {
+  auto overlay = Overlay::get();
+  Scopes scopes;
+  int skip_depth = 0;
+  bool close_skipped = false; // Call the close of the skipped scope anyway (End, EndChild)
+
+  while (r.ok && r.p < r.end) {
+    auto op = static_cast<Op>(r.u8());
+    bool active = skip_depth == 0;
+
+    if (!active) {
+      if (is_open(op)) {
+        skip_depth++;
+      } else if (is_close(op) && --skip_depth == 0) {
+        active = close_skipped;
+      }
+    }
+
+    Op closes = opener(op);
+    if (closes != Op::Count) {
+      if (active && !scopes.pop(closes))
+        r.ok = false; // Doesn't close the innermost scope
+      continue;
+    }
+
+    // Opens a scope that is skipped when the widget returned false. The scope is tracked
+    // whenever its close has to be called.
+    auto scope = [&](Op open_op, bool open, bool close_always) {
+      results.boolean(open);
+      if ((open || close_always) && !scopes.push(open_op)) {
+        close_scope(open_op);
+        r.ok = false;
+        return;
+      }
+      if (!open) {
+        skip_depth = 1;
+        close_skipped = close_always;
+      }
+    };
+
+    switch (op) {
+    case Op::Text: {
+      size_t len;
+      const char *s = r.str(&len);
+      if (active)
+        ImGui::TextUnformatted(s, s + len);
+      break;
+    }
+    case Op::TextColored: {
+      float c[4] = {r.f32(), r.f32(), r.f32(), r.f32()};
+      size_t len;
+      const char *s = r.str(&len);
+      if (active)
+        imgui_api::text_colored_unformatted(c[0], c[1], c[2], c[3], s, s + len);
+      break;
+    }
+    case Op::TextWrapped: {
+      size_t len;
+      const char *s = r.str(&len);
+      if (active)
+        imgui_api::text_wrapped_unformatted(s, s + len);
+      break;
+    }
+    case Op::Button: {
+      const char *label = r.str();
+      float w = r.f32(), h = r.f32();
+      if (active)
+        results.boolean(ImGui::Button(label, ImVec2(w, h)));
+      else
+        results.skip(1);
+      break;
+    }
+    case Op::SmallButton: {
+      const char *label = r.str();
+      if (active)
+        results.boolean(ImGui::SmallButton(label));
+      else
+        results.skip(1);
+      break;
+    }
+    case Op::Checkbox: {
+      const char *label = r.str();
+      bool value = r.b8();
+      if (active) {
+        results.boolean(ImGui::Checkbox(label, &value));
+        results.boolean(value);
+      } else {
+        results.skip(2);
+      }
+      break;
+    }
+    case Op::SliderFloat: {
+      const char *label = r.str();
+      float value = r.f32(), min = r.f32(), max = r.f32();
+      if (active) {
+        results.boolean(ImGui::SliderFloat(label, &value, min, max));
+        results.number(value);
+      } else {
+        results.skip(2);
+      }
+      break;
+    }
+    case Op::SliderInt: {
+      const char *label = r.str();
+      int value = r.i32(), min = r.i32(), max = r.i32();
+      if (active) {
+        results.boolean(ImGui::SliderInt(label, &value, min, max));
+        results.number(value);
+      } else {
+        results.skip(2);
+      }
+      break;
+    }
+    case Op::DragFloat: {
+      const char *label = r.str();
+      float value = r.f32(), speed = r.f32(), min = r.f32(), max = r.f32();
+      if (active) {
+        results.boolean(ImGui::DragFloat(label, &value, speed, min, max));
+        results.number(value);
+      } else {
+        results.skip(2);
+      }
+      break;
+    }
+    case Op::DragInt: {
+      const char *label = r.str();
+      int value = r.i32();
+      float speed = r.f32();
+      int min = r.i32(), max = r.i32();
+      if (active) {
+        results.boolean(ImGui::DragInt(label, &value, speed, min, max));
+        results.number(value);
+      } else {
+        results.skip(2);
+      }
+      break;
+    }
+    case Op::InputFloat: {
+      const char *label = r.str();
+      float value = r.f32();
+      if (active) {
+        results.boolean(ImGui::InputFloat(label, &value));
+        results.number(value);
+      } else {
+        results.skip(2);
+      }
+      break;
+    }
+    case Op::InputInt: {
+      const char *label = r.str();
+      int value = r.i32();
+      if (active) {
+        results.boolean(ImGui::InputInt(label, &value));
+        results.number(value);
+      } else {
+        results.skip(2);
+      }
+      break;
+    }
+    case Op::SameLine: {
+      float offset = r.f32(), spacing = r.f32();
+      if (active)
+        ImGui::SameLine(offset, spacing);
+      break;
+    }
+    case Op::Separator:
+      if (active)
+        ImGui::Separator();
+      break;
+    case Op::Spacing:
+      if (active)
+        ImGui::Spacing();
+      break;
+    case Op::NewLine:
+      if (active)
+        ImGui::NewLine();
+      break;
+    case Op::Indent: {
+      float w = r.f32();
+      if (active)
+        ImGui::Indent(w);
+      break;
+    }
+    case Op::Unindent: {
+      float w = r.f32();
+      if (active)
+        ImGui::Unindent(w);
+      break;
+    }
+    case Op::SetNextItemWidth: {
+      float w = r.f32();
+      if (active)
+        ImGui::SetNextItemWidth(w);
+      break;
+    }
+    case Op::PushId: {
+      const char *id = r.str();
+      if (active && scopes.push(Op::PushId))
+        ImGui::PushID(id);
+      else if (active)
+        r.ok = false;
+      break;
+    }
+    case Op::Selectable: {
+      const char *label = r.str();
+      bool selected = r.b8();
+      if (active)
+        results.boolean(ImGui::Selectable(label, selected));
+      else
+        results.skip(1);
+      break;
+    }
+    case Op::ProgressBar: {
+      float fraction = r.f32(), w = r.f32(), h = r.f32();
+      if (active)
+        ImGui::ProgressBar(fraction, ImVec2(w, h));
+      break;
+    }
+    case Op::IsItemHovered:
+      if (active)
+        results.boolean(ImGui::IsItemHovered());
+      else
+        results.skip(1);
+      break;
+    case Op::SetTooltip: {
+      size_t len;
+      const char *s = r.str(&len);
+      if (active)
+        imgui_api::set_tooltip_unformatted(s, s + len);
+      break;
+    }
+
+    case Op::BeginWindow: {
+      const char *name = r.str();
+      int flags = r.i32();
+      if (!active) {
+        results.skip(1);
+      } else if (!name[0] || !overlay || !overlay->is_window_shown(name)) {
+        // Hidden with the overlay, never begun, so End isn't called either
+        scope(Op::BeginWindow, false, false);
+      } else {
+        scope(Op::BeginWindow, ImGui::Begin(name, nullptr, flags), true);
+      }
+      break;
+    }
+    case Op::BeginChild: {
+      const char *id = r.str();
+      float w = r.f32(), h = r.f32();
+      int child_flags = r.i32(), window_flags = r.i32();
+      if (active)
+        scope(Op::BeginChild, ImGui::BeginChild(id, ImVec2(w, h), child_flags, window_flags), true);
+      else
+        results.skip(1);
+      break;
+    }
+    case Op::TreeNode: {
+      const char *label = r.str();
+      if (active)
+        scope(Op::TreeNode, ImGui::TreeNode(label), false);
+      else
+        results.skip(1);
+      break;
+    }
+    case Op::CollapsingHeader: {
+      const char *label = r.str();
+      if (active)
+        scope(Op::CollapsingHeader, ImGui::CollapsingHeader(label), false);
+      else
+        results.skip(1);
+      break;
+    }
+    case Op::BeginTabBar: {
+      const char *id = r.str();
+      if (active)
+        scope(Op::BeginTabBar, ImGui::BeginTabBar(id), false);
+      else
+        results.skip(1);
+      break;
+    }
+    case Op::BeginTabItem: {
+      const char *label = r.str();
+      if (active)
+        scope(Op::BeginTabItem, ImGui::BeginTabItem(label), false);
+      else
+        results.skip(1);
+      break;
+    }
+    case Op::BeginCombo: {
+      const char *label = r.str();
+      const char *preview = r.str();
+      if (active)
+        scope(Op::BeginCombo, ImGui::BeginCombo(label, preview), false);
+      else
+        results.skip(1);
+      break;
+    }
+
+    default:
+      r.ok = false;
+      break;
+    }
+  }
+
+  // Ending inside a scope is as malformed as breaking off, either way close what's open
+  if (scopes.depth > 0 || skip_depth > 0)
+    r.ok = false;
+  scopes.unwind();
+  return r.ok;
+}
+
+} // namespace
+
+int submit(lua_State *L) {
+  auto lua = g_api->lua;
+
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+  int arg = 2;
+  if (lua->type(L, 1) == 4) { // LUA_TSTRING
+    data = reinterpret_cast<const uint8_t *>(lua->tolstring(L, 1, &size));
+  } else if (void *pointer = binding::to_pointer(L, 1)) { // Followed by its size
+    data = static_cast<const uint8_t *>(pointer);
+    double n = lua->tonumber(L, 2);
+    size = n > 0 ? static_cast<size_t>(n) : 0;
+    arg = 3;
+  }
+
+  Results results{L};
+  if (lua->type(L, arg) == 5) { // LUA_TTABLE
+    results.table = arg;
+  } else if (void *pointer = binding::to_pointer(L, arg)) {
+    results.out = static_cast<double *>(pointer);
+    double n = lua->tonumber(L, arg + 1);
+    results.capacity = n > 0 ? static_cast<size_t>(n) : 0;
+  }
+
+  // Widgets only exist inside a frame
+  auto overlay = Overlay::get();
+  bool ok = data != nullptr;
+  if (ok && overlay && overlay->in_frame()) {
+    Reader reader{data, data + size};
+    ok = run(reader, results);
+  }
+
+  lua->pushnumber(L, static_cast<double>(results.count));
+  lua->pushboolean(L, ok);
+  return 2;
+}
+
+void register_opcodes(lua_State *L) {
+  auto lua = g_api->lua;
+  static const struct {
+    const char *name;
+    Op op;
+  } opcodes[] = {
+      {"Cmd_Text", Op::Text},
+      {"Cmd_TextColored", Op::TextColored},
+      {"Cmd_TextWrapped", Op::TextWrapped},
+      {"Cmd_Button", Op::Button},
+      {"Cmd_SmallButton", Op::SmallButton},
+      {"Cmd_Checkbox", Op::Checkbox},
+      {"Cmd_SliderFloat", Op::SliderFloat},
+      {"Cmd_SliderInt", Op::SliderInt},
+      {"Cmd_DragFloat", Op::DragFloat},
+      {"Cmd_DragInt", Op::DragInt},
+      {"Cmd_InputFloat", Op::InputFloat},
+      {"Cmd_InputInt", Op::InputInt},
+      {"Cmd_SameLine", Op::SameLine},
+      {"Cmd_Separator", Op::Separator},
+      {"Cmd_Spacing", Op::Spacing},
+      {"Cmd_NewLine", Op::NewLine},
+      {"Cmd_Indent", Op::Indent},
+      {"Cmd_Unindent", Op::Unindent},
+      {"Cmd_SetNextItemWidth", Op::SetNextItemWidth},
+      {"Cmd_PushId", Op::PushId},
+      {"Cmd_PopId", Op::PopId},
+      {"Cmd_Selectable", Op::Selectable},
+      {"Cmd_ProgressBar", Op::ProgressBar},
+      {"Cmd_IsItemHovered", Op::IsItemHovered},
+      {"Cmd_SetTooltip", Op::SetTooltip},
+      {"Cmd_BeginWindow", Op::BeginWindow},
+      {"Cmd_EndWindow", Op::EndWindow},
+      {"Cmd_BeginChild", Op::BeginChild},
+      {"Cmd_EndChild", Op::EndChild},
+      {"Cmd_TreeNode", Op::TreeNode},
+      {"Cmd_TreePop", Op::TreePop},
+      {"Cmd_CollapsingHeader", Op::CollapsingHeader},
+      {"Cmd_EndCollapsingHeader", Op::EndCollapsingHeader},
+      {"Cmd_BeginTabBar", Op::BeginTabBar},
+      {"Cmd_EndTabBar", Op::EndTabBar},
+      {"Cmd_BeginTabItem", Op::BeginTabItem},
+      {"Cmd_EndTabItem", Op::EndTabItem},
+      {"Cmd_BeginCombo", Op::BeginCombo},
+      {"Cmd_EndCombo", Op::EndCombo},
+  };
+  static_assert(sizeof(opcodes) / sizeof(opcodes[0]) == static_cast<size_t>(Op::Count) - 1,
+                "every opcode needs a Lua name");
+
+  for (const auto &entry : opcodes) {
+    lua->pushnumber(L, static_cast<double>(entry.op));
+    lua->setfield(L, -2, entry.name);
+  }
+}
+
+} // namespace command_buffer
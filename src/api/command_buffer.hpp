@@ -0,0 +1,67 @@
+#pragma once
+#include <lje_sdk.h>
+#include <cstdint>
+
+// imgui.submit: runs a whole batch of widget calls from one flat command buffer, so a
+// window costs one Lua -> C transition instead of one per widget.
+namespace command_buffer {
+
+// Opcodes, one byte each, followed by their packed little-endian arguments:
+// f = f32, i = i32, b = u8 (0 or 1), s = u16 length, the bytes and a terminating NUL.
+// Widgets with results append them to the result array in order, skipped or not.
+enum class Op : uint8_t {
+  Text = 1,         // s
+  TextColored,      // f f f f s
+  TextWrapped,      // s
+  Button,           // s f f           -> pressed
+  SmallButton,      // s               -> pressed
+  Checkbox,         // s b             -> changed, value
+  SliderFloat,      // s f f f         -> changed, value
+  SliderInt,        // s i i i         -> changed, value
+  DragFloat,        // s f f f f       -> changed, value
+  DragInt,          // s i f i i       -> changed, value
+  InputFloat,       // s f             -> changed, value
+  InputInt,         // s i             -> changed, value
+  SameLine,         // f f
+  Separator,        //
+  Spacing,          //
+  NewLine,          //
+  Indent,           // f
+  Unindent,         // f
+  SetNextItemWidth, // f
+  PushId,           // s
+  PopId,            //
+  Selectable,       // s b             -> pressed
+  ProgressBar,      // f f f
+  IsItemHovered,    //                 -> hovered
+  SetTooltip,       // s
+
+  // Scopes: when the opening widget returns false, everything up to its matching close
+  // is skipped. EndWindow and EndChild are still called, as ImGui requires.
+  BeginWindow,      // s i             -> visible
+  EndWindow,        //
+  BeginChild,       // s f f i i       -> visible
+  EndChild,         //
+  TreeNode,         // s               -> open
+  TreePop,          //
+  CollapsingHeader, // s               -> open
+  EndCollapsingHeader,
+  BeginTabBar,      // s               -> open
+  EndTabBar,        //
+  BeginTabItem,     // s               -> open
+  EndTabItem,       //
+  BeginCombo,       // s s             -> open
+  EndCombo,         //
+  Count
+};
+
+// imgui.submit(buffer, [results], [capacity]): buffer is a string, or an FFI array or
+// lightuserdata followed by its size in bytes. Results go into a table (booleans and
+// numbers) or a double array, FFI or lightuserdata, of capacity entries. Returns the number of results and
+// false if the buffer was malformed or unbalanced; scopes it left open are closed.
+int submit(lua_State *L);
+
+// Cmd_* opcode constants, into the table on top of the stack
+void register_opcodes(lua_State *L);
+
+} // namespace command_buffer
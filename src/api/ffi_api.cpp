@@ -0,0 +1,146 @@
+#include "ffi_api.hpp"
+#include "imgui_api.hpp"
+#include "../globals.hpp"
+#include <Windows.h>
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#define LJE_IMGUI_EXPORT extern "C" __declspec(dllexport)
+
+// Keep in sync with the exports below, the names and signatures are a stable ABI
+static const char *CDEF = R"(
+void ljeimgui_text(const char *text);
+void ljeimgui_text_colored(float r, float g, float b, float a, const char *text);
+bool ljeimgui_button(const char *label, float w, float h);
+bool ljeimgui_small_button(const char *label);
+bool ljeimgui_checkbox(const char *label, bool *value);
+bool ljeimgui_slider_float(const char *label, float *value, float min, float max);
+bool ljeimgui_slider_int(const char *label, int *value, int min, int max);
+bool ljeimgui_drag_float(const char *label, float *value, float speed, float min, float max);
+bool ljeimgui_drag_int(const char *label, int *value, float speed, int min, int max);
+bool ljeimgui_selectable(const char *label, bool selected);
+void ljeimgui_same_line(float offset, float spacing);
+void ljeimgui_separator(void);
+void ljeimgui_set_next_item_width(float width);
+void ljeimgui_push_id(const char *id);
+void ljeimgui_push_id_int(int id);
+void ljeimgui_pop_id(void);
+bool ljeimgui_begin_window(const char *name, bool *open, int flags);
+void ljeimgui_end_window(void);
+)";
+
+// C callers bypass the Lua bindings, so every export checks for a frame (calls before init
+// or between frames are ignored) and reads null strings as ""
+static bool in_frame() {
+  ImGuiContext *ctx = ImGui::GetCurrentContext();
+  return ctx && ctx->WithinFrameScope;
+}
+
+static const char *str(const char *s) {
+  return s ? s : "";
+}
+
+LJE_IMGUI_EXPORT void ljeimgui_text(const char *text) {
+  if (in_frame())
+    ImGui::TextUnformatted(str(text));
+}
+
+LJE_IMGUI_EXPORT void ljeimgui_text_colored(float r, float g, float b, float a, const char *text) {
+  if (!in_frame())
+    return;
+  ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(r, g, b, a));
+  ImGui::TextUnformatted(str(text));
+  ImGui::PopStyleColor();
+}
+
+LJE_IMGUI_EXPORT bool ljeimgui_button(const char *label, float w, float h) {
+  return in_frame() && ImGui::Button(str(label), ImVec2(w, h));
+}
+
+LJE_IMGUI_EXPORT bool ljeimgui_small_button(const char *label) {
+  return in_frame() && ImGui::SmallButton(str(label));
+}
+
+LJE_IMGUI_EXPORT bool ljeimgui_checkbox(const char *label, bool *value) {
+  return value && in_frame() && ImGui::Checkbox(str(label), value);
+}
+
+LJE_IMGUI_EXPORT bool ljeimgui_slider_float(const char *label, float *value, float min, float max) {
+  return value && in_frame() && ImGui::SliderFloat(str(label), value, min, max);
+}
+
+LJE_IMGUI_EXPORT bool ljeimgui_slider_int(const char *label, int *value, int min, int max) {
+  return value && in_frame() && ImGui::SliderInt(str(label), value, min, max);
+}
+
+LJE_IMGUI_EXPORT bool ljeimgui_drag_float(const char *label, float *value, float speed, float min, float max) {
+  return value && in_frame() && ImGui::DragFloat(str(label), value, speed, min, max);
+}
+
+LJE_IMGUI_EXPORT bool ljeimgui_drag_int(const char *label, int *value, float speed, int min, int max) {
+  return value && in_frame() && ImGui::DragInt(str(label), value, speed, min, max);
+}
+
+LJE_IMGUI_EXPORT bool ljeimgui_selectable(const char *label, bool selected) {
+  return in_frame() && ImGui::Selectable(str(label), selected);
+}
+
+LJE_IMGUI_EXPORT void ljeimgui_same_line(float offset, float spacing) {
+  if (in_frame())
+    ImGui::SameLine(offset, spacing);
+}
+
+LJE_IMGUI_EXPORT void ljeimgui_separator(void) {
+  if (in_frame())
+    ImGui::Separator();
+}
+
+LJE_IMGUI_EXPORT void ljeimgui_set_next_item_width(float width) {
+  if (in_frame())
+    ImGui::SetNextItemWidth(width);
+}
+
+LJE_IMGUI_EXPORT void ljeimgui_push_id(const char *id) {
+  if (in_frame())
+    ImGui::PushID(str(id));
+}
+
+LJE_IMGUI_EXPORT void ljeimgui_push_id_int(int id) {
+  if (in_frame())
+    ImGui::PushID(id);
+}
+
+LJE_IMGUI_EXPORT void ljeimgui_pop_id(void) {
+  if (in_frame())
+    ImGui::PopID();
+}
+
+LJE_IMGUI_EXPORT bool ljeimgui_begin_window(const char *name, bool *open, int flags) {
+  return imgui_api::window_begin(name, open, flags);
+}
+
+LJE_IMGUI_EXPORT void ljeimgui_end_window(void) {
+  imgui_api::window_end();
+}
+
+namespace ffi_api {
+
+void register_all(lua_State *L) {
+  auto lua = g_api->lua;
+
+  lua->pushstring(L, CDEF);
+  lua->setfield(L, -2, "ffi_cdef");
+
+  // ffi.C only sees the game's executable and system libraries, scripts ffi.load this DLL
+  HMODULE self = nullptr;
+  GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                     reinterpret_cast<LPCSTR>(&ljeimgui_text), &self);
+  char path[MAX_PATH] = {};
+  DWORD len = GetModuleFileNameA(self, path, MAX_PATH);
+  if (len > 0 && len < MAX_PATH) {
+    lua->pushstring(L, path);
+    lua->setfield(L, -2, "ffi_module");
+  }
+}
+
+} // namespace ffi_api
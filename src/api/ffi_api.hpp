@@ -0,0 +1,12 @@
+#pragma once
+#include <lje_sdk.h>
+
+// Plain C exports of the hot widgets, for LuaJIT's FFI. Unlike lua_CFunctions, FFI calls
+// don't abort traces, so UI loops calling these can be JIT-compiled.
+namespace ffi_api {
+
+// imgui.ffi_cdef (declarations for ffi.cdef) and imgui.ffi_module (path for ffi.load),
+// into the table on top of the stack
+void register_all(lua_State *L);
+
+} // namespace ffi_api
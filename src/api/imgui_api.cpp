@@ -1,14 +1,24 @@
 #include "imgui_api.hpp"
+#include "binding.hpp"
+#include "command_buffer.hpp"
+#include "ffi_api.hpp"
 #include "../globals.hpp"
+#include "../log.hpp"
 #include "../overlay.hpp"
 #include <imgui.h>
-#include <imgui_impl_dx9.h>
+#include <imgui_internal.h>
+#include <string>
+#include <tuple>
 #include <vector>
 #include <cfloat>
 #include <cstring>
 
 namespace imgui_api {
 
+using binding::bind;
+using binding::Opt;
+using binding::Str;
+
 // Color name to ImGuiCol mapping
 static int get_color_index(const char *name) {
   struct ColorMapping {
@@ -160,10 +170,60 @@ static bool read_vec2_from_table(lua_State *L, int table_idx, ImVec2 &vec) {
   return false;
 }
 
+// IDs
+// Resolves an ID argument: a handle from imgui.id, or a string hashed through the ID cache
+static bool read_id(lua_State *L, int idx, ImGuiID &id) {
+  auto lua = g_api->lua;
+  if (lua->type(L, idx) == 2) { // LUA_TLIGHTUSERDATA
+    id = static_cast<ImGuiID>(reinterpret_cast<uintptr_t>(lua->tolightuserdata(L, idx)));
+    return true;
+  }
+
+  size_t len = 0;
+  const char *str = lua->tolstring(L, idx, &len);
+  auto overlay = Overlay::get();
+  if (!str || !overlay || !overlay->in_frame())
+    return false;
+  id = overlay->id_cache().get(str, len);
+  return true;
+}
+
+static int id(lua_State *L) {
+  auto lua = g_api->lua;
+  ImGuiID result = 0;
+  if (!read_id(L, 1, result))
+    return 0;
+  lua->pushlightuserdata(L, reinterpret_cast<void *>(static_cast<uintptr_t>(result)));
+  return 1;
+}
+
+static int get_id_cache_stats(lua_State *L) {
+  auto lua = g_api->lua;
+  auto overlay = Overlay::get();
+  IdCache::Stats stats;
+  if (overlay)
+    stats = overlay->id_cache().stats();
+
+  uint64_t lookups = stats.hits + stats.misses;
+  lua->createtable(L, 0, 5);
+  lua->pushnumber(L, static_cast<double>(stats.hits));
+  lua->setfield(L, -2, "hits");
+  lua->pushnumber(L, static_cast<double>(stats.misses));
+  lua->setfield(L, -2, "misses");
+  lua->pushnumber(L, lookups ? static_cast<double>(stats.hits) / lookups : 0.0);
+  lua->setfield(L, -2, "hit_rate");
+  lua->pushnumber(L, static_cast<double>(stats.entries));
+  lua->setfield(L, -2, "entries");
+  lua->pushnumber(L, static_cast<double>(stats.evicted));
+  lua->setfield(L, -2, "evicted");
+  return 1;
+}
+
 // Child Window
 static int begin_child(lua_State *L) {
   auto lua = g_api->lua;
-  const char *id = lua->tolstring(L, 1, nullptr);
+  ImGuiID id = 0;
+  bool has_id = read_id(L, 1, id) && (lua->type(L, 1) != 4 || lua->objlen(L, 1) > 0); // Empty LUA_TSTRING
   float w = 0, h = 0;
   int child_flags = 0;
   int window_flags = 0;
@@ -179,7 +239,7 @@ static int begin_child(lua_State *L) {
     window_flags = static_cast<int>(lua->tonumber(L, 5));
   lua->pop(L, nargs);
 
-  if (!id || id[0] == '\0') {
+  if (!has_id) {
     lua->pushboolean(L, false);
     return 1;
   }
@@ -196,75 +256,72 @@ static int end_child(lua_State *L) {
 }
 
 // Scrolling
-static int get_scroll_x(lua_State *L) {
-  auto lua = g_api->lua;
-  lua->pushnumber(L, ImGui::GetScrollX());
-  return 1;
+static float get_scroll_x() {
+  return ImGui::GetScrollX();
 }
 
-static int get_scroll_y(lua_State *L) {
-  auto lua = g_api->lua;
-  lua->pushnumber(L, ImGui::GetScrollY());
-  return 1;
+static float get_scroll_y() {
+  return ImGui::GetScrollY();
 }
 
-static int set_scroll_x(lua_State *L) {
-  auto lua = g_api->lua;
-  float scroll_x = static_cast<float>(lua->tonumber(L, 1));
-  lua->pop(L, 1);
+static void set_scroll_x(float scroll_x) {
   ImGui::SetScrollX(scroll_x);
-  return 0;
 }
 
-static int set_scroll_y(lua_State *L) {
-  auto lua = g_api->lua;
-  float scroll_y = static_cast<float>(lua->tonumber(L, 1));
-  lua->pop(L, 1);
+static void set_scroll_y(float scroll_y) {
   ImGui::SetScrollY(scroll_y);
-  return 0;
 }
 
-static int get_scroll_max_x(lua_State *L) {
-  auto lua = g_api->lua;
-  lua->pushnumber(L, ImGui::GetScrollMaxX());
-  return 1;
+static float get_scroll_max_x() {
+  return ImGui::GetScrollMaxX();
 }
 
-static int get_scroll_max_y(lua_State *L) {
-  auto lua = g_api->lua;
-  lua->pushnumber(L, ImGui::GetScrollMaxY());
-  return 1;
+static float get_scroll_max_y() {
+  return ImGui::GetScrollMaxY();
 }
 
-static int set_scroll_here_x(lua_State *L) {
-  auto lua = g_api->lua;
-  float center_x_ratio = 0.5f;
-  int nargs = lua->gettop(L);
-  if (nargs >= 1)
-    center_x_ratio = static_cast<float>(lua->tonumber(L, 1));
-  lua->pop(L, nargs);
+static void set_scroll_here_x(Opt<float, 0.5f> center_x_ratio) {
   ImGui::SetScrollHereX(center_x_ratio);
-  return 0;
 }
 
-static int set_scroll_here_y(lua_State *L) {
-  auto lua = g_api->lua;
-  float center_y_ratio = 0.5f;
-  int nargs = lua->gettop(L);
-  if (nargs >= 1)
-    center_y_ratio = static_cast<float>(lua->tonumber(L, 1));
-  lua->pop(L, nargs);
+static void set_scroll_here_y(Opt<float, 0.5f> center_y_ratio) {
   ImGui::SetScrollHereY(center_y_ratio);
-  return 0;
 }
 
 // Window
+// One entry per begin_window call, true when ImGui::Begin was not called for it
+static std::vector<bool> skipped_windows;
+
+bool window_begin(const char *name, bool *open, int flags) {
+  // Windows hidden with the overlay are never begun at all, window_end has to know
+  auto overlay = Overlay::get();
+  if (!name || name[0] == '\0' || !overlay || !overlay->in_frame() || !overlay->is_window_shown(name)) {
+    skipped_windows.push_back(true);
+    return false;
+  }
+  skipped_windows.push_back(false);
+  return ImGui::Begin(name, open, flags);
+}
+
+void window_end() {
+  // An end without a begin (or outside a frame) is ignored
+  bool skipped = true;
+  if (!skipped_windows.empty()) {
+    skipped = skipped_windows.back();
+    skipped_windows.pop_back();
+  }
+  if (!skipped)
+    ImGui::End();
+}
+
 static int begin_window(lua_State *L) {
   auto lua = g_api->lua;
   const char *name = lua->tolstring(L, 1, nullptr);
   bool open = true;
   bool has_close_button = true;
   int flags = 0;
+  bool has_version = false;
+  double version = 0.0;
 
   int nargs = lua->gettop(L);
   if (nargs >= 2 && !lua->isnil(L, 2)) {
@@ -275,86 +332,109 @@ static int begin_window(lua_State *L) {
   if (nargs >= 3) {
     flags = static_cast<int>(lua->tonumber(L, 3));
   }
+  if (nargs >= 4 && !lua->isnil(L, 4)) {
+    has_version = true;
+    version = lua->tonumber(L, 4);
+  }
   lua->pop(L, nargs);
 
-  if (!name || name[0] == '\0') {
-    lua->pushboolean(L, false);
-    lua->pushboolean(L, false);
-    return 2;
-  }
+  bool visible = window_begin(name, has_close_button ? &open : nullptr, flags);
+
+  // Content versioning: if nothing changed since the last build, the caller can skip the
+  // window's widgets and the overlay reuses its previous geometry
+  bool cached = false;
+  if (visible && has_version)
+    cached = Overlay::get()->window_cache().begin_window(ImGui::GetCurrentWindow(), version);
 
-  bool visible = ImGui::Begin(name, has_close_button ? &open : nullptr, flags);
   lua->pushboolean(L, visible);
   lua->pushboolean(L, open);
-  return 2;
+  lua->pushboolean(L, cached);
+  return 3;
 }
 
 static int end_window(lua_State *L) {
-  ImGui::End();
+  (void)L;
+  window_end();
   return 0;
 }
 
-// Text
-static int text(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *str = lua->tolstring(L, 1, nullptr);
-  lua->pop(L, 1);
-  ImGui::Text("%s", str);
-  return 0;
+// Text, the Lua length is passed along so ImGui doesn't format or strlen the string
+void text_colored_unformatted(float r, float g, float b, float a, const char *begin, const char *end) {
+  ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(r, g, b, a));
+  ImGui::TextUnformatted(begin, end);
+  ImGui::PopStyleColor();
 }
 
-static int text_colored(lua_State *L) {
-  auto lua = g_api->lua;
-  float r = static_cast<float>(lua->tonumber(L, 1));
-  float g = static_cast<float>(lua->tonumber(L, 2));
-  float b = static_cast<float>(lua->tonumber(L, 3));
-  float a = static_cast<float>(lua->tonumber(L, 4));
-  const char *str = lua->tolstring(L, 5, nullptr);
-  lua->pop(L, 5);
-  ImGui::TextColored(ImVec4(r, g, b, a), "%s", str);
-  return 0;
+void text_wrapped_unformatted(const char *begin, const char *end) {
+  // Same as TextWrapped, which only wraps at the window edge when no wrap pos is pushed
+  bool push_wrap = ImGui::GetCurrentWindow()->DC.TextWrapPos < 0.0f;
+  if (push_wrap)
+    ImGui::PushTextWrapPos(0.0f);
+  ImGui::TextUnformatted(begin, end);
+  if (push_wrap)
+    ImGui::PopTextWrapPos();
+}
+
+static void text(Str str) {
+  ImGui::TextUnformatted(str.data, str.end());
+}
+
+static void text_colored(float r, float g, float b, float a, Str str) {
+  text_colored_unformatted(r, g, b, a, str.data, str.end());
+}
+
+static void text_wrapped(Str str) {
+  text_wrapped_unformatted(str.data, str.end());
 }
 
-static int text_wrapped(lua_State *L) {
+// Draws many lines with only the visible ones touched: a table of strings, one line each,
+// goes through a list clipper, and a string or FFI array and size of newline-separated
+// text goes to TextUnformatted, which skips lines outside the clip rect on its own.
+static int text_lines(lua_State *L) {
   auto lua = g_api->lua;
-  const char *str = lua->tolstring(L, 1, nullptr);
-  lua->pop(L, 1);
-  ImGui::TextWrapped("%s", str);
+  int type = lua->type(L, 1);
+
+  if (type == 5) { // LUA_TTABLE
+    int count = static_cast<int>(lua->objlen(L, 1));
+    ImGuiListClipper clipper;
+    clipper.Begin(count, ImGui::GetTextLineHeightWithSpacing());
+    while (clipper.Step()) {
+      for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++) {
+        lua->rawgeti(L, 1, i + 1);
+        size_t len = 0;
+        const char *line = lua->tolstring(L, -1, &len);
+        if (line)
+          ImGui::TextUnformatted(line, line + len);
+        else
+          ImGui::NewLine();
+        lua->pop(L, 1);
+      }
+    }
+  } else if (type == 4) { // LUA_TSTRING
+    size_t len = 0;
+    const char *str = lua->tolstring(L, 1, &len);
+    ImGui::TextUnformatted(str, str + len);
+  } else if (void *pointer = binding::to_pointer(L, 1)) { // Followed by its size
+    auto data = static_cast<const char *>(pointer);
+    double n = lua->tonumber(L, 2);
+    if (data && n > 0)
+      ImGui::TextUnformatted(data, data + static_cast<size_t>(n));
+  }
   return 0;
 }
 
 // Buttons
-static int button(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  float w = 0, h = 0;
-  int nargs = lua->gettop(L);
-  if (nargs >= 2)
-    w = static_cast<float>(lua->tonumber(L, 2));
-  if (nargs >= 3)
-    h = static_cast<float>(lua->tonumber(L, 3));
-  lua->pop(L, nargs);
-  lua->pushboolean(L, ImGui::Button(label, ImVec2(w, h)));
-  return 1;
+static bool button(const char *label, Opt<float> w, Opt<float> h) {
+  return ImGui::Button(label, ImVec2(w, h));
 }
 
-static int small_button(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  lua->pop(L, 1);
-  lua->pushboolean(L, ImGui::SmallButton(label));
-  return 1;
+static bool small_button(const char *label) {
+  return ImGui::SmallButton(label);
 }
 
-static int checkbox(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  bool value = lua->toboolean(L, 2);
-  lua->pop(L, 2);
+static std::tuple<bool, bool> checkbox(const char *label, bool value) {
   bool changed = ImGui::Checkbox(label, &value);
-  lua->pushboolean(L, changed);
-  lua->pushboolean(L, value);
-  return 2;
+  return {changed, value};
 }
 
 // Input
@@ -418,101 +498,50 @@ static int input_text_multiline(lua_State *L) {
   return 2;
 }
 
-static int input_float(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  float value = static_cast<float>(lua->tonumber(L, 2));
-  lua->pop(L, 2);
+static std::tuple<bool, float> input_float(const char *label, float value) {
   bool changed = ImGui::InputFloat(label, &value);
-  lua->pushboolean(L, changed);
-  lua->pushnumber(L, value);
-  return 2;
+  return {changed, value};
 }
 
-static int input_int(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  int value = static_cast<int>(lua->tonumber(L, 2));
-  lua->pop(L, 2);
+static std::tuple<bool, int> input_int(const char *label, int value) {
   bool changed = ImGui::InputInt(label, &value);
-  lua->pushboolean(L, changed);
-  lua->pushnumber(L, value);
-  return 2;
+  return {changed, value};
 }
 
 // Sliders
-static int slider_float(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  float value = static_cast<float>(lua->tonumber(L, 2));
-  float min = static_cast<float>(lua->tonumber(L, 3));
-  float max = static_cast<float>(lua->tonumber(L, 4));
-  lua->pop(L, 4);
+static std::tuple<bool, float> slider_float(const char *label, float value, float min, float max) {
   bool changed = ImGui::SliderFloat(label, &value, min, max);
-  lua->pushboolean(L, changed);
-  lua->pushnumber(L, value);
-  return 2;
+  return {changed, value};
 }
 
-static int slider_int(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  int value = static_cast<int>(lua->tonumber(L, 2));
-  int min = static_cast<int>(lua->tonumber(L, 3));
-  int max = static_cast<int>(lua->tonumber(L, 4));
-  lua->pop(L, 4);
+static std::tuple<bool, int> slider_int(const char *label, int value, int min, int max) {
   bool changed = ImGui::SliderInt(label, &value, min, max);
-  lua->pushboolean(L, changed);
-  lua->pushnumber(L, value);
-  return 2;
+  return {changed, value};
 }
 
 // Layout
-static int same_line(lua_State *L) {
-  auto lua = g_api->lua;
-  float offset = 0, spacing = -1;
-  int nargs = lua->gettop(L);
-  if (nargs >= 1)
-    offset = static_cast<float>(lua->tonumber(L, 1));
-  if (nargs >= 2)
-    spacing = static_cast<float>(lua->tonumber(L, 2));
-  lua->pop(L, nargs);
-  ImGui::SameLine(offset, spacing);
-  return 0;
+static void same_line(Opt<float> offset, Opt<float, -1.0f> spacing_w) {
+  ImGui::SameLine(offset, spacing_w);
 }
 
-static int separator(lua_State *L) {
+static void separator() {
   ImGui::Separator();
-  return 0;
 }
 
-static int spacing(lua_State *L) {
+static void spacing() {
   ImGui::Spacing();
-  return 0;
 }
 
-static int new_line(lua_State *L) {
+static void new_line() {
   ImGui::NewLine();
-  return 0;
 }
 
-static int indent(lua_State *L) {
-  auto lua = g_api->lua;
-  float indent_w = 0.0f;
-  int nargs = lua->gettop(L);
-  if (nargs >= 1)
-    indent_w = static_cast<float>(lua->tonumber(L, 1));
-  lua->pop(L, nargs);
+static void indent(Opt<float> indent_w) {
   ImGui::Indent(indent_w);
-  return 0;
 }
 
-static int set_next_item_width(lua_State *L) {
-  auto lua = g_api->lua;
-  float width = static_cast<float>(lua->tonumber(L, 1));
-  lua->pop(L, 1);
+static void set_next_item_width(float width) {
   ImGui::SetNextItemWidth(width);
-  return 0;
 }
 
 static int push_id(lua_State *L) {
@@ -524,8 +553,10 @@ static int push_id(lua_State *L) {
       int id = static_cast<int>(lua->tonumber(L, 1));
       ImGui::PushID(id);
     } else {
-      const char *str_id = lua->tolstring(L, 1, nullptr);
-      ImGui::PushID(str_id);
+      // Same as PushID(str), with the hash coming from the ID cache
+      ImGuiID id = 0;
+      if (read_id(L, 1, id))
+        ImGui::PushOverrideID(id);
     }
   }
   lua->pop(L, nargs);
@@ -538,238 +569,246 @@ static int pop_id(lua_State *L) {
   return 0;
 }
 
-static int unindent(lua_State *L) {
-  auto lua = g_api->lua;
-  float indent_w = 0.0f;
-  int nargs = lua->gettop(L);
-  if (nargs >= 1)
-    indent_w = static_cast<float>(lua->tonumber(L, 1));
-  lua->pop(L, nargs);
+static void unindent(Opt<float> indent_w) {
   ImGui::Unindent(indent_w);
-  return 0;
 }
 
 // Collapsing/Tree
-static int collapsing_header(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  lua->pop(L, 1);
-  lua->pushboolean(L, ImGui::CollapsingHeader(label));
-  return 1;
+static bool collapsing_header(const char *label) {
+  return ImGui::CollapsingHeader(label);
 }
 
-static int tree_node(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  lua->pop(L, 1);
-  lua->pushboolean(L, ImGui::TreeNode(label));
-  return 1;
+static bool tree_node(const char *label) {
+  return ImGui::TreeNode(label);
 }
 
-static int tree_pop(lua_State *L) {
+static void tree_pop() {
   ImGui::TreePop();
-  return 0;
 }
 
 // Combo
-static int begin_combo(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  const char *preview = lua->tolstring(L, 2, nullptr);
-  lua->pop(L, 2);
-  lua->pushboolean(L, ImGui::BeginCombo(label, preview));
-  return 1;
+static bool begin_combo(const char *label, Opt<const char *> preview) {
+  return ImGui::BeginCombo(label, preview);
 }
 
-static int end_combo(lua_State *L) {
+static void end_combo() {
   ImGui::EndCombo();
-  return 0;
 }
 
-static int selectable(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  bool selected = false;
-  int nargs = lua->gettop(L);
-  if (nargs >= 2)
-    selected = lua->toboolean(L, 2);
-  lua->pop(L, nargs);
-  lua->pushboolean(L, ImGui::Selectable(label, selected));
-  return 1;
+static bool selectable(const char *label, Opt<bool> selected) {
+  return ImGui::Selectable(label, selected);
 }
 
 // Color
-static int color_edit4(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  float r = static_cast<float>(lua->tonumber(L, 2));
-  float g = static_cast<float>(lua->tonumber(L, 3));
-  float b = static_cast<float>(lua->tonumber(L, 4));
-  float a = static_cast<float>(lua->tonumber(L, 5));
-  lua->pop(L, 5);
-
+static std::tuple<bool, float, float, float, float> color_edit4(const char *label, float r, float g, float b,
+                                                               float a) {
   float col[4] = {r, g, b, a};
   bool changed = ImGui::ColorEdit4(label, col);
-
-  lua->pushboolean(L, changed);
-  lua->pushnumber(L, col[0]);
-  lua->pushnumber(L, col[1]);
-  lua->pushnumber(L, col[2]);
-  lua->pushnumber(L, col[3]);
-  return 5;
+  return {changed, col[0], col[1], col[2], col[3]};
 }
 
-static int color_picker4(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  float r = static_cast<float>(lua->tonumber(L, 2));
-  float g = static_cast<float>(lua->tonumber(L, 3));
-  float b = static_cast<float>(lua->tonumber(L, 4));
-  float a = static_cast<float>(lua->tonumber(L, 5));
-  lua->pop(L, 5);
-
+static std::tuple<bool, float, float, float, float> color_picker4(const char *label, float r, float g, float b,
+                                                                 float a) {
   float col[4] = {r, g, b, a};
   bool changed = ImGui::ColorPicker4(label, col);
-
-  lua->pushboolean(L, changed);
-  lua->pushnumber(L, col[0]);
-  lua->pushnumber(L, col[1]);
-  lua->pushnumber(L, col[2]);
-  lua->pushnumber(L, col[3]);
-  return 5;
+  return {changed, col[0], col[1], col[2], col[3]};
 }
 
 // Tooltips
-static int set_tooltip(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *text = lua->tolstring(L, 1, nullptr);
-  lua->pop(L, 1);
-  ImGui::SetTooltip("%s", text);
-  return 0;
+void set_tooltip_unformatted(const char *begin, const char *end) {
+  if (!ImGui::BeginTooltipEx(ImGuiTooltipFlags_OverridePrevious, ImGuiWindowFlags_None))
+    return;
+  ImGui::TextUnformatted(begin, end);
+  ImGui::EndTooltip();
 }
 
-static int begin_tooltip(lua_State *L) {
-  lua_State *Ls = L;
-  (void)Ls;
+static void set_tooltip(Str text) {
+  set_tooltip_unformatted(text.data, text.end());
+}
+
+static void begin_tooltip() {
   ImGui::BeginTooltip();
-  return 0;
 }
 
-static int end_tooltip(lua_State *L) {
-  lua_State *Ls = L;
-  (void)Ls;
+static void end_tooltip() {
   ImGui::EndTooltip();
-  return 0;
 }
 
-static int is_item_hovered(lua_State *L) {
-  auto lua = g_api->lua;
-  lua->pushboolean(L, ImGui::IsItemHovered());
-  return 1;
+static bool is_item_hovered() {
+  return ImGui::IsItemHovered();
 }
 
 // Tabs
-static int begin_tab_bar(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *id = lua->tolstring(L, 1, nullptr);
-  lua->pop(L, 1);
-  lua->pushboolean(L, ImGui::BeginTabBar(id));
-  return 1;
+static bool begin_tab_bar(const char *id) {
+  return ImGui::BeginTabBar(id);
 }
 
-static int end_tab_bar(lua_State *L) {
-  lua_State *Ls = L;
-  (void)Ls;
+static void end_tab_bar() {
   ImGui::EndTabBar();
-  return 0;
 }
 
-static int begin_tab_item(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  lua->pop(L, 1);
-  lua->pushboolean(L, ImGui::BeginTabItem(label));
-  return 1;
+static bool begin_tab_item(const char *label) {
+  return ImGui::BeginTabItem(label);
 }
 
-static int end_tab_item(lua_State *L) {
-  lua_State *Ls = L;
-  (void)Ls;
+static void end_tab_item() {
   ImGui::EndTabItem();
-  return 0;
 }
 
 // Progress
-static int progress_bar(lua_State *L) {
+static void progress_bar(float fraction, Opt<float, -1.0f> w, Opt<float> h, Opt<const char *> overlay) {
+  ImGui::ProgressBar(fraction, ImVec2(w, h), overlay);
+}
+
+// Textures
+static int create_texture(lua_State *L) {
   auto lua = g_api->lua;
-  float fraction = static_cast<float>(lua->tonumber(L, 1));
+  int w = static_cast<int>(lua->tonumber(L, 1));
+  int h = static_cast<int>(lua->tonumber(L, 2));
+  auto format = UserTextures::Format::RGBA32;
+
   int nargs = lua->gettop(L);
+  if (nargs >= 3) {
+    const char *name = lua->tolstring(L, 3, nullptr);
+    if (name && strcmp(name, "alpha8") == 0)
+      format = UserTextures::Format::Alpha8;
+  }
+  lua->pop(L, nargs);
+
+  auto overlay = Overlay::get();
+  lua->pushlightuserdata(L, overlay ? overlay->textures().create(w, h, format) : nullptr);
+  return 1;
+}
 
-  float w = -1, h = 0;
-  const char *overlay = nullptr;
+// Rect coordinates as int, out-of-range values (and NaN) read as 0 and fail validation
+static int read_coord(lua_State *L, int idx) {
+  double v = g_api->lua->tonumber(L, idx);
+  return v > -1e6 && v < 1e6 ? static_cast<int>(v) : 0;
+}
 
-  if (nargs >= 2)
-    w = static_cast<float>(lua->tonumber(L, 2));
-  if (nargs >= 3)
-    h = static_cast<float>(lua->tonumber(L, 3));
-  if (nargs >= 4)
-    overlay = lua->tolstring(L, 4, nullptr);
+// update_texture(tex, data, [rect]) - data is a string, FFI array or lightuserdata holding
+// tightly packed pixels, rect is {x, y, w, h} and defaults to the whole texture
+static int update_texture(lua_State *L) {
+  auto lua = g_api->lua;
+  auto tex = static_cast<ImTextureData *>(lua->tolightuserdata(L, 1));
+  auto overlay = Overlay::get();
+  int nargs = lua->gettop(L);
+  if (!overlay || !tex || !overlay->textures().contains(tex)) {
+    lua->pop(L, nargs);
+    lua->pushboolean(L, false);
+    return 1;
+  }
+
+  int x = 0, y = 0, w = tex->Width, h = tex->Height;
+  if (nargs >= 3 && lua->type(L, 3) == 5) { // LUA_TTABLE
+    lua->rawgeti(L, 3, 1);
+    x = read_coord(L, -1);
+    lua->rawgeti(L, 3, 2);
+    y = read_coord(L, -1);
+    lua->rawgeti(L, 3, 3);
+    w = read_coord(L, -1);
+    lua->rawgeti(L, 3, 4);
+    h = read_coord(L, -1);
+    lua->pop(L, 4);
+  }
 
+  // Pixels are read straight from the Lua string or pointer into the texture
+  const void *data = nullptr;
+  size_t size = 0;
+  if (lua->type(L, 2) == 4) { // LUA_TSTRING
+    data = lua->tolstring(L, 2, &size);
+  } else if (void *pointer = binding::to_pointer(L, 2)) { // Trusted to cover the rect
+    data = pointer;
+    int bpp = overlay->textures().format(tex) == UserTextures::Format::Alpha8 ? 1 : 4;
+    size = static_cast<size_t>(w > 0 ? w : 0) * static_cast<size_t>(h > 0 ? h : 0) * bpp;
+  }
+
+  bool ok = w > 0 && h > 0 && overlay->textures().update(tex, data, size, x, y, w, h);
   lua->pop(L, nargs);
-  ImGui::ProgressBar(fraction, ImVec2(w, h), overlay);
+  lua->pushboolean(L, ok);
+  return 1;
+}
+
+static int destroy_texture(lua_State *L) {
+  auto lua = g_api->lua;
+  auto tex = static_cast<ImTextureData *>(lua->tolightuserdata(L, 1));
+  lua->pop(L, lua->gettop(L));
+
+  auto overlay = Overlay::get();
+  if (overlay && tex)
+    overlay->textures().destroy(tex);
   return 0;
 }
 
-// Drag
-static int drag_float(lua_State *L) {
+// Reads the optional u0, v0, u1, v1 arguments starting at first
+static void read_uvs(lua_State *L, int first, int nargs, ImVec2 &uv0, ImVec2 &uv1) {
   auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  float value = static_cast<float>(lua->tonumber(L, 2));
-  float speed = 1.0f, min = 0.0f, max = 0.0f;
+  if (nargs >= first)
+    uv0.x = static_cast<float>(lua->tonumber(L, first));
+  if (nargs >= first + 1)
+    uv0.y = static_cast<float>(lua->tonumber(L, first + 1));
+  if (nargs >= first + 2)
+    uv1.x = static_cast<float>(lua->tonumber(L, first + 2));
+  if (nargs >= first + 3)
+    uv1.y = static_cast<float>(lua->tonumber(L, first + 3));
+}
 
+static int image(lua_State *L) {
+  auto lua = g_api->lua;
+  auto tex = static_cast<ImTextureData *>(lua->tolightuserdata(L, 1));
+  float w = static_cast<float>(lua->tonumber(L, 2));
+  float h = static_cast<float>(lua->tonumber(L, 3));
   int nargs = lua->gettop(L);
-  if (nargs >= 3)
-    speed = static_cast<float>(lua->tonumber(L, 3));
-  if (nargs >= 4)
-    min = static_cast<float>(lua->tonumber(L, 4));
-  if (nargs >= 5)
-    max = static_cast<float>(lua->tonumber(L, 5));
 
+  ImVec2 uv0(0, 0), uv1(1, 1);
+  read_uvs(L, 4, nargs, uv0, uv1);
   lua->pop(L, nargs);
-  bool changed = ImGui::DragFloat(label, &value, speed, min, max);
-  lua->pushboolean(L, changed);
-  lua->pushnumber(L, value);
-  return 2;
+
+  auto overlay = Overlay::get();
+  if (overlay && tex && overlay->textures().contains(tex))
+    ImGui::Image(tex->GetTexRef(), ImVec2(w, h), uv0, uv1);
+  return 0;
 }
 
-static int drag_int(lua_State *L) {
+static int image_button(lua_State *L) {
   auto lua = g_api->lua;
-  const char *label = lua->tolstring(L, 1, nullptr);
-  int value = static_cast<int>(lua->tonumber(L, 2));
-  float speed = 1.0f;
-  int min = 0, max = 0;
-
+  const char *id = lua->tolstring(L, 1, nullptr);
+  auto tex = static_cast<ImTextureData *>(lua->tolightuserdata(L, 2));
+  float w = static_cast<float>(lua->tonumber(L, 3));
+  float h = static_cast<float>(lua->tonumber(L, 4));
   int nargs = lua->gettop(L);
-  if (nargs >= 3)
-    speed = static_cast<float>(lua->tonumber(L, 3));
-  if (nargs >= 4)
-    min = static_cast<int>(lua->tonumber(L, 4));
-  if (nargs >= 5)
-    max = static_cast<int>(lua->tonumber(L, 5));
+
+  ImVec2 uv0(0, 0), uv1(1, 1);
+  read_uvs(L, 5, nargs, uv0, uv1);
+
+  bool pressed = false;
+  auto overlay = Overlay::get();
+  if (id && overlay && tex && overlay->textures().contains(tex))
+    pressed = ImGui::ImageButton(id, tex->GetTexRef(), ImVec2(w, h), uv0, uv1);
 
   lua->pop(L, nargs);
+  lua->pushboolean(L, pressed);
+  return 1;
+}
+
+// Drag
+static std::tuple<bool, float> drag_float(const char *label, float value, Opt<float, 1.0f> speed, Opt<float> min,
+                                          Opt<float> max) {
+  bool changed = ImGui::DragFloat(label, &value, speed, min, max);
+  return {changed, value};
+}
+
+static std::tuple<bool, int> drag_int(const char *label, int value, Opt<float, 1.0f> speed, Opt<int> min,
+                                      Opt<int> max) {
   bool changed = ImGui::DragInt(label, &value, speed, min, max);
-  lua->pushboolean(L, changed);
-  lua->pushnumber(L, value);
-  return 2;
+  return {changed, value};
 }
 
 // Popups/Modals
 static int open_popup(lua_State *L) {
-  auto lua = g_api->lua;
-  const char *id = lua->tolstring(L, 1, nullptr);
-  lua->pop(L, 1);
-  ImGui::OpenPopup(id);
+  ImGuiID id = 0;
+  if (read_id(L, 1, id))
+    ImGui::OpenPopup(id);
   return 0;
 }
 
@@ -812,9 +851,8 @@ static int close_current_popup(lua_State *L) {
 
 static int is_popup_open(lua_State *L) {
   auto lua = g_api->lua;
-  const char *id = lua->tolstring(L, 1, nullptr);
-  lua->pop(L, 1);
-  lua->pushboolean(L, ImGui::IsPopupOpen(id));
+  ImGuiID id = 0;
+  lua->pushboolean(L, read_id(L, 1, id) && ImGui::IsPopupOpen(id, 0));
   return 1;
 }
 
@@ -911,6 +949,7 @@ static int plot_histogram(lua_State *L) {
 
 // Frame control
 static int new_frame(lua_State *L) {
+  skipped_windows.clear();
   auto overlay = Overlay::get();
   if (overlay)
     overlay->new_frame();
@@ -924,6 +963,31 @@ static int render(lua_State *L) {
   return 0;
 }
 
+// UI update rate
+static int set_ui_rate(lua_State *L) {
+  auto lua = g_api->lua;
+  float hz = static_cast<float>(lua->tonumber(L, 1));
+  lua->pop(L, 1);
+  auto overlay = Overlay::get();
+  if (overlay)
+    overlay->set_ui_rate(hz);
+  return 0;
+}
+
+static int get_ui_rate(lua_State *L) {
+  auto lua = g_api->lua;
+  auto overlay = Overlay::get();
+  lua->pushnumber(L, overlay ? overlay->ui_rate() : 0.0f);
+  return 1;
+}
+
+static int should_update(lua_State *L) {
+  auto lua = g_api->lua;
+  auto overlay = Overlay::get();
+  lua->pushboolean(L, !overlay || overlay->should_update());
+  return 1;
+}
+
 // Visibility
 static int set_visible(lua_State *L) {
   auto lua = g_api->lua;
@@ -942,6 +1006,229 @@ static int is_visible(lua_State *L) {
   return 1;
 }
 
+static int set_hud_windows(lua_State *L) {
+  auto lua = g_api->lua;
+  std::vector<std::string> names;
+  int nargs = lua->gettop(L);
+  if (nargs >= 1 && lua->type(L, 1) == 5) { // LUA_TTABLE
+    int count = static_cast<int>(lua->objlen(L, 1));
+    for (int i = 1; i <= count; i++) {
+      lua->rawgeti(L, 1, i);
+      const char *name = lua->tolstring(L, -1, nullptr);
+      if (name)
+        names.emplace_back(name);
+      lua->pop(L, 1);
+    }
+  }
+  lua->pop(L, nargs);
+
+  auto overlay = Overlay::get();
+  if (overlay)
+    overlay->set_hud_windows(std::move(names));
+  return 0;
+}
+
+// Idle throttling
+static int set_idle_policy(lua_State *L) {
+  auto lua = g_api->lua;
+  int frames = static_cast<int>(lua->tonumber(L, 1));
+  float hz = 5.0f;
+  int nargs = lua->gettop(L);
+  if (nargs >= 2)
+    hz = static_cast<float>(lua->tonumber(L, 2));
+  lua->pop(L, nargs);
+
+  auto overlay = Overlay::get();
+  if (overlay)
+    overlay->set_idle_policy(frames, hz);
+  return 0;
+}
+
+static int is_idle(lua_State *L) {
+  auto lua = g_api->lua;
+  auto overlay = Overlay::get();
+  lua->pushboolean(L, overlay && overlay->is_idle());
+  return 1;
+}
+
+// Profiler
+static int enable_profiler(lua_State *L) {
+  auto lua = g_api->lua;
+  bool enabled = lua->toboolean(L, 1);
+  lua->pop(L, 1);
+  auto overlay = Overlay::get();
+  if (overlay)
+    overlay->profiler().set_enabled(enabled);
+  return 0;
+}
+
+static int show_profiler(lua_State *L) {
+  auto lua = g_api->lua;
+  bool show = lua->toboolean(L, 1);
+  lua->pop(L, 1);
+  auto overlay = Overlay::get();
+  if (overlay) {
+    if (show)
+      overlay->profiler().set_enabled(true);
+    overlay->profiler().set_window_shown(show);
+  }
+  return 0;
+}
+
+// Returns { [phase] = { last, p50, p99, max, samples } } in milliseconds plus the renderer's
+// counts for the last frame, or nil when disabled
+static int get_frame_stats(lua_State *L) {
+  auto lua = g_api->lua;
+  auto overlay = Overlay::get();
+  if (!overlay || !overlay->profiler().enabled())
+    return 0;
+
+  auto &profiler = overlay->profiler();
+  lua->createtable(L, 0, Profiler::PHASE_COUNT);
+  for (int i = 0; i < Profiler::PHASE_COUNT; ++i) {
+    auto phase = static_cast<Profiler::Phase>(i);
+    auto summary = profiler.summary(phase);
+
+    lua->createtable(L, 0, 5);
+    lua->pushnumber(L, summary.last);
+    lua->setfield(L, -2, "last");
+    lua->pushnumber(L, summary.p50);
+    lua->setfield(L, -2, "p50");
+    lua->pushnumber(L, summary.p99);
+    lua->setfield(L, -2, "p99");
+    lua->pushnumber(L, summary.max);
+    lua->setfield(L, -2, "max");
+    lua->pushnumber(L, summary.samples);
+    lua->setfield(L, -2, "samples");
+    lua->setfield(L, -2, Profiler::phase_name(phase));
+  }
+
+  // Device work of the last drawn frame
+  if (Renderer *renderer = overlay->renderer()) {
+    auto stats = renderer->frame_stats();
+    lua->createtable(L, 0, 6);
+    lua->pushstring(L, renderer->name());
+    lua->setfield(L, -2, "name");
+    lua->pushnumber(L, stats.draw_calls);
+    lua->setfield(L, -2, "draw_calls");
+    lua->pushnumber(L, stats.state_calls);
+    lua->setfield(L, -2, "state_calls");
+    lua->pushnumber(L, stats.locks);
+    lua->setfield(L, -2, "locks");
+    lua->pushnumber(L, stats.bytes_uploaded);
+    lua->setfield(L, -2, "bytes_uploaded");
+    lua->pushnumber(L, stats.buffer_creates);
+    lua->setfield(L, -2, "buffer_creates");
+    lua->setfield(L, -2, "renderer");
+  }
+  return 1;
+}
+
+// Draw optimization
+static int set_draw_optimization(lua_State *L) {
+  auto lua = g_api->lua;
+  bool enabled = lua->toboolean(L, 1);
+  lua->pop(L, 1);
+  auto overlay = Overlay::get();
+  if (overlay)
+    overlay->set_draw_optimization(enabled);
+  return 0;
+}
+
+// Returns { commands, draw_calls, culled, merged, saved } for the last captured frame
+static int get_draw_stats(lua_State *L) {
+  auto lua = g_api->lua;
+  auto overlay = Overlay::get();
+  DrawOptimizer::Stats stats;
+  if (overlay)
+    stats = overlay->draw_stats();
+
+  lua->createtable(L, 0, 5);
+  lua->pushnumber(L, stats.commands);
+  lua->setfield(L, -2, "commands");
+  lua->pushnumber(L, stats.draw_calls);
+  lua->setfield(L, -2, "draw_calls");
+  lua->pushnumber(L, stats.culled);
+  lua->setfield(L, -2, "culled");
+  lua->pushnumber(L, stats.merged);
+  lua->setfield(L, -2, "merged");
+  lua->pushnumber(L, stats.commands - stats.draw_calls);
+  lua->setfield(L, -2, "saved");
+  return 1;
+}
+
+// Input recording
+static int record_input(lua_State *L) {
+  auto lua = g_api->lua;
+  const char *path = lua->tolstring(L, 1, nullptr);
+  auto overlay = Overlay::get();
+  bool ok = path && overlay && overlay->input_recorder().start_recording(path);
+  lua->pop(L, 1);
+  lua->pushboolean(L, ok);
+  return 1;
+}
+
+static int replay_input(lua_State *L) {
+  auto lua = g_api->lua;
+  const char *path = lua->tolstring(L, 1, nullptr);
+  auto overlay = Overlay::get();
+  bool ok = path && overlay && overlay->input_recorder().start_replay(path);
+  lua->pop(L, 1);
+  lua->pushboolean(L, ok);
+  return 1;
+}
+
+static int stop_input(lua_State *L) {
+  auto overlay = Overlay::get();
+  if (overlay)
+    overlay->input_recorder().stop();
+  return 0;
+}
+
+static int get_input_status(lua_State *L) {
+  auto lua = g_api->lua;
+  auto overlay = Overlay::get();
+  if (!overlay) {
+    lua->pushstring(L, "idle");
+    return 1;
+  }
+
+  auto &recorder = overlay->input_recorder();
+  switch (recorder.mode()) {
+  case InputRecorder::Mode::Recording: lua->pushstring(L, "recording"); break;
+  case InputRecorder::Mode::Replaying: lua->pushstring(L, "replaying"); break;
+  default: lua->pushstring(L, "idle"); break;
+  }
+  lua->pushnumber(L, recorder.frame());
+  lua->pushnumber(L, recorder.frame_count());
+  return 3;
+}
+
+// Logging
+static int set_log_level(lua_State *L) {
+  auto lua = g_api->lua;
+  const char *name = lua->tolstring(L, 1, nullptr);
+  lua->pop(L, 1);
+  if (!name)
+    return 0;
+
+  static const char *names[] = {"debug", "info", "warn", "error"};
+  for (int i = 0; i < 4; ++i) {
+    if (strcmp(name, names[i]) == 0)
+      logger::set_level(static_cast<logger::Level>(i));
+  }
+  return 0;
+}
+
+static int set_log_file(lua_State *L) {
+  auto lua = g_api->lua;
+  const char *path = lua->isnil(L, 1) ? nullptr : lua->tolstring(L, 1, nullptr);
+  bool ok = logger::set_file(path);
+  lua->pop(L, 1);
+  lua->pushboolean(L, ok);
+  return 1;
+}
+
 // Input capture queries
 static int want_capture_mouse(lua_State *L) {
   auto lua = g_api->lua;
@@ -956,6 +1243,8 @@ static int want_capture_keyboard(lua_State *L) {
 }
 
 // Fonts
+// load_font returns a handle at once, the font is read in the background and can be used
+// from the first frame after font_ready(handle) turns true
 static int load_font(lua_State *L) {
   auto lua = g_api->lua;
   const char *path = lua->tolstring(L, 1, nullptr);
@@ -964,25 +1253,43 @@ static int load_font(lua_State *L) {
   int nargs = lua->gettop(L);
   if (nargs >= 2)
     size = static_cast<float>(lua->tonumber(L, 2));
-  lua->pop(L, nargs);
 
-  if (!path || path[0] == '\0') {
+  auto overlay = Overlay::get();
+  if (!overlay || !path || path[0] == '\0') {
+    lua->pop(L, nargs);
     lua->pushlightuserdata(L, nullptr);
     return 1;
   }
 
-  ImGuiIO &io = ImGui::GetIO();
-  ImFont *font = io.Fonts->AddFontFromFileTTF(path, size);
+  auto handle = overlay->fonts().load(path, size);
+  lua->pop(L, nargs);
+  lua->pushlightuserdata(L, handle);
+  return 1;
+}
 
-  if (font) {
-    // Mark atlas as needing rebuild
-    io.Fonts->Build();
-    // Invalidate DX9 font texture so it gets recreated
-    ImGui_ImplDX9_InvalidateDeviceObjects();
+static int font_ready(lua_State *L) {
+  auto lua = g_api->lua;
+  void *ptr = lua->tolightuserdata(L, 1);
+  lua->pop(L, 1);
+
+  auto overlay = Overlay::get();
+  auto handle = overlay ? overlay->fonts().find(ptr) : nullptr;
+  if (!handle) {
+    // Plain fonts, like the one from get_default_font, are always ready
+    lua->pushboolean(L, ptr != nullptr);
+    lua->pushboolean(L, ptr == nullptr);
+    return 2;
   }
 
-  lua->pushlightuserdata(L, font);
-  return 1;
+  auto status = handle->status.load();
+  lua->pushboolean(L, status == FontLoader::Status::Ready);
+  lua->pushboolean(L, status == FontLoader::Status::Failed);
+  return 2;
+}
+
+static ImFont *resolve_font(void *ptr) {
+  auto overlay = Overlay::get();
+  return overlay ? overlay->fonts().resolve(ptr) : static_cast<ImFont *>(ptr);
 }
 
 static int push_font(lua_State *L) {
@@ -990,7 +1297,10 @@ static int push_font(lua_State *L) {
   void *font_ptr = lua->tolightuserdata(L, 1);
   lua->pop(L, 1);
 
-  ImFont *font = static_cast<ImFont *>(font_ptr);
+  // A font still loading pushes the current one, so push/pop stay balanced
+  ImFont *font = resolve_font(font_ptr);
+  if (!font && font_ptr)
+    font = ImGui::GetFont();
   if (font) {
     ImGui::PushFont(font);
   }
@@ -1008,7 +1318,14 @@ static int set_default_font(lua_State *L) {
   void *font_ptr = lua->tolightuserdata(L, 1);
   lua->pop(L, 1);
 
-  ImFont *font = static_cast<ImFont *>(font_ptr);
+  auto overlay = Overlay::get();
+  auto handle = overlay ? overlay->fonts().find(font_ptr) : nullptr;
+  if (handle && !handle->font) {
+    handle->make_default = true; // Applied once it is loaded
+    return 0;
+  }
+
+  ImFont *font = resolve_font(font_ptr);
   if (font) {
     ImGuiIO &io = ImGui::GetIO();
     io.FontDefault = font;
@@ -1311,37 +1628,39 @@ void register_all(lua_State *L) {
   lua->setfield(L, -2, "WindowFlags_NoInputs");
 
   // Scrolling
-  lua->pushcclosure(L, get_scroll_x, 0);
+  lua->pushcclosure(L, bind<get_scroll_x>, 0);
   lua->setfield(L, -2, "get_scroll_x");
-  lua->pushcclosure(L, get_scroll_y, 0);
+  lua->pushcclosure(L, bind<get_scroll_y>, 0);
   lua->setfield(L, -2, "get_scroll_y");
-  lua->pushcclosure(L, set_scroll_x, 0);
+  lua->pushcclosure(L, bind<set_scroll_x>, 0);
   lua->setfield(L, -2, "set_scroll_x");
-  lua->pushcclosure(L, set_scroll_y, 0);
+  lua->pushcclosure(L, bind<set_scroll_y>, 0);
   lua->setfield(L, -2, "set_scroll_y");
-  lua->pushcclosure(L, get_scroll_max_x, 0);
+  lua->pushcclosure(L, bind<get_scroll_max_x>, 0);
   lua->setfield(L, -2, "get_scroll_max_x");
-  lua->pushcclosure(L, get_scroll_max_y, 0);
+  lua->pushcclosure(L, bind<get_scroll_max_y>, 0);
   lua->setfield(L, -2, "get_scroll_max_y");
-  lua->pushcclosure(L, set_scroll_here_x, 0);
+  lua->pushcclosure(L, bind<set_scroll_here_x>, 0);
   lua->setfield(L, -2, "set_scroll_here_x");
-  lua->pushcclosure(L, set_scroll_here_y, 0);
+  lua->pushcclosure(L, bind<set_scroll_here_y>, 0);
   lua->setfield(L, -2, "set_scroll_here_y");
 
   // Text
-  lua->pushcclosure(L, text, 0);
+  lua->pushcclosure(L, bind<text>, 0);
   lua->setfield(L, -2, "text");
-  lua->pushcclosure(L, text_colored, 0);
+  lua->pushcclosure(L, bind<text_colored>, 0);
   lua->setfield(L, -2, "text_colored");
-  lua->pushcclosure(L, text_wrapped, 0);
+  lua->pushcclosure(L, bind<text_wrapped>, 0);
   lua->setfield(L, -2, "text_wrapped");
+  lua->pushcclosure(L, text_lines, 0);
+  lua->setfield(L, -2, "text_lines");
 
   // Buttons
-  lua->pushcclosure(L, button, 0);
+  lua->pushcclosure(L, bind<button>, 0);
   lua->setfield(L, -2, "button");
-  lua->pushcclosure(L, small_button, 0);
+  lua->pushcclosure(L, bind<small_button>, 0);
   lua->setfield(L, -2, "small_button");
-  lua->pushcclosure(L, checkbox, 0);
+  lua->pushcclosure(L, bind<checkbox>, 0);
   lua->setfield(L, -2, "checkbox");
 
   // Input
@@ -1349,9 +1668,9 @@ void register_all(lua_State *L) {
   lua->setfield(L, -2, "input_text");
   lua->pushcclosure(L, input_text_multiline, 0);
   lua->setfield(L, -2, "input_text_multiline");
-  lua->pushcclosure(L, input_float, 0);
+  lua->pushcclosure(L, bind<input_float>, 0);
   lua->setfield(L, -2, "input_float");
-  lua->pushcclosure(L, input_int, 0);
+  lua->pushcclosure(L, bind<input_int>, 0);
   lua->setfield(L, -2, "input_int");
 
   // InputText Flags
@@ -1389,81 +1708,97 @@ void register_all(lua_State *L) {
   lua->setfield(L, -2, "InputTextFlags_NoUndoRedo");
 
   // Sliders
-  lua->pushcclosure(L, slider_float, 0);
+  lua->pushcclosure(L, bind<slider_float>, 0);
   lua->setfield(L, -2, "slider_float");
-  lua->pushcclosure(L, slider_int, 0);
+  lua->pushcclosure(L, bind<slider_int>, 0);
   lua->setfield(L, -2, "slider_int");
 
   // Layout
-  lua->pushcclosure(L, same_line, 0);
+  lua->pushcclosure(L, bind<same_line>, 0);
   lua->setfield(L, -2, "same_line");
-  lua->pushcclosure(L, separator, 0);
+  lua->pushcclosure(L, bind<separator>, 0);
   lua->setfield(L, -2, "separator");
-  lua->pushcclosure(L, spacing, 0);
+  lua->pushcclosure(L, bind<spacing>, 0);
   lua->setfield(L, -2, "spacing");
-  lua->pushcclosure(L, new_line, 0);
+  lua->pushcclosure(L, bind<new_line>, 0);
   lua->setfield(L, -2, "new_line");
-  lua->pushcclosure(L, indent, 0);
+  lua->pushcclosure(L, bind<indent>, 0);
   lua->setfield(L, -2, "indent");
-  lua->pushcclosure(L, unindent, 0);
+  lua->pushcclosure(L, bind<unindent>, 0);
   lua->setfield(L, -2, "unindent");
-  lua->pushcclosure(L, set_next_item_width, 0);
+  lua->pushcclosure(L, bind<set_next_item_width>, 0);
   lua->setfield(L, -2, "set_next_item_width");
   lua->pushcclosure(L, push_id, 0);
   lua->setfield(L, -2, "push_id");
   lua->pushcclosure(L, pop_id, 0);
   lua->setfield(L, -2, "pop_id");
+  lua->pushcclosure(L, id, 0);
+  lua->setfield(L, -2, "id");
+  lua->pushcclosure(L, get_id_cache_stats, 0);
+  lua->setfield(L, -2, "get_id_cache_stats");
 
   // Collapsing/Tree
-  lua->pushcclosure(L, collapsing_header, 0);
+  lua->pushcclosure(L, bind<collapsing_header>, 0);
   lua->setfield(L, -2, "collapsing_header");
-  lua->pushcclosure(L, tree_node, 0);
+  lua->pushcclosure(L, bind<tree_node>, 0);
   lua->setfield(L, -2, "tree_node");
-  lua->pushcclosure(L, tree_pop, 0);
+  lua->pushcclosure(L, bind<tree_pop>, 0);
   lua->setfield(L, -2, "tree_pop");
 
   // Combo
-  lua->pushcclosure(L, begin_combo, 0);
+  lua->pushcclosure(L, bind<begin_combo>, 0);
   lua->setfield(L, -2, "begin_combo");
-  lua->pushcclosure(L, end_combo, 0);
+  lua->pushcclosure(L, bind<end_combo>, 0);
   lua->setfield(L, -2, "end_combo");
-  lua->pushcclosure(L, selectable, 0);
+  lua->pushcclosure(L, bind<selectable>, 0);
   lua->setfield(L, -2, "selectable");
 
   // Color
-  lua->pushcclosure(L, color_edit4, 0);
+  lua->pushcclosure(L, bind<color_edit4>, 0);
   lua->setfield(L, -2, "color_edit4");
-  lua->pushcclosure(L, color_picker4, 0);
+  lua->pushcclosure(L, bind<color_picker4>, 0);
   lua->setfield(L, -2, "color_picker4");
 
   // Tooltips
-  lua->pushcclosure(L, set_tooltip, 0);
+  lua->pushcclosure(L, bind<set_tooltip>, 0);
   lua->setfield(L, -2, "set_tooltip");
-  lua->pushcclosure(L, begin_tooltip, 0);
+  lua->pushcclosure(L, bind<begin_tooltip>, 0);
   lua->setfield(L, -2, "begin_tooltip");
-  lua->pushcclosure(L, end_tooltip, 0);
+  lua->pushcclosure(L, bind<end_tooltip>, 0);
   lua->setfield(L, -2, "end_tooltip");
-  lua->pushcclosure(L, is_item_hovered, 0);
+  lua->pushcclosure(L, bind<is_item_hovered>, 0);
   lua->setfield(L, -2, "is_item_hovered");
 
   // Tabs
-  lua->pushcclosure(L, begin_tab_bar, 0);
+  lua->pushcclosure(L, bind<begin_tab_bar>, 0);
   lua->setfield(L, -2, "begin_tab_bar");
-  lua->pushcclosure(L, end_tab_bar, 0);
+  lua->pushcclosure(L, bind<end_tab_bar>, 0);
   lua->setfield(L, -2, "end_tab_bar");
-  lua->pushcclosure(L, begin_tab_item, 0);
+  lua->pushcclosure(L, bind<begin_tab_item>, 0);
   lua->setfield(L, -2, "begin_tab_item");
-  lua->pushcclosure(L, end_tab_item, 0);
+  lua->pushcclosure(L, bind<end_tab_item>, 0);
   lua->setfield(L, -2, "end_tab_item");
 
   // Progress
-  lua->pushcclosure(L, progress_bar, 0);
+  lua->pushcclosure(L, bind<progress_bar>, 0);
   lua->setfield(L, -2, "progress_bar");
 
+  // Textures
+  lua->pushcclosure(L, create_texture, 0);
+  lua->setfield(L, -2, "create_texture");
+  lua->pushcclosure(L, update_texture, 0);
+  lua->setfield(L, -2, "update_texture");
+  lua->pushcclosure(L, destroy_texture, 0);
+  lua->setfield(L, -2, "destroy_texture");
+  lua->pushcclosure(L, image, 0);
+  lua->setfield(L, -2, "image");
+  lua->pushcclosure(L, image_button, 0);
+  lua->setfield(L, -2, "image_button");
+
   // Drag
-  lua->pushcclosure(L, drag_float, 0);
+  lua->pushcclosure(L, bind<drag_float>, 0);
   lua->setfield(L, -2, "drag_float");
-  lua->pushcclosure(L, drag_int, 0);
+  lua->pushcclosure(L, bind<drag_int>, 0);
   lua->setfield(L, -2, "drag_int");
 
   // Popups/Modals
@@ -1491,6 +1826,8 @@ void register_all(lua_State *L) {
   lua->setfield(L, -2, "set_visible");
   lua->pushcclosure(L, is_visible, 0);
   lua->setfield(L, -2, "is_visible");
+  lua->pushcclosure(L, set_hud_windows, 0);
+  lua->setfield(L, -2, "set_hud_windows");
 
   // Input capture queries
   lua->pushcclosure(L, want_capture_mouse, 0);
@@ -1504,9 +1841,51 @@ void register_all(lua_State *L) {
   lua->pushcclosure(L, render, 0);
   lua->setfield(L, -2, "render");
 
+  // UI update rate
+  lua->pushcclosure(L, set_ui_rate, 0);
+  lua->setfield(L, -2, "set_ui_rate");
+  lua->pushcclosure(L, get_ui_rate, 0);
+  lua->setfield(L, -2, "get_ui_rate");
+  lua->pushcclosure(L, should_update, 0);
+  lua->setfield(L, -2, "should_update");
+  lua->pushcclosure(L, set_idle_policy, 0);
+  lua->setfield(L, -2, "set_idle_policy");
+  lua->pushcclosure(L, is_idle, 0);
+  lua->setfield(L, -2, "is_idle");
+
+  // Profiler
+  lua->pushcclosure(L, enable_profiler, 0);
+  lua->setfield(L, -2, "enable_profiler");
+  lua->pushcclosure(L, show_profiler, 0);
+  lua->setfield(L, -2, "show_profiler");
+  lua->pushcclosure(L, get_frame_stats, 0);
+  lua->setfield(L, -2, "get_frame_stats");
+  lua->pushcclosure(L, set_draw_optimization, 0);
+  lua->setfield(L, -2, "set_draw_optimization");
+  lua->pushcclosure(L, get_draw_stats, 0);
+  lua->setfield(L, -2, "get_draw_stats");
+
+  // Input recording
+  lua->pushcclosure(L, record_input, 0);
+  lua->setfield(L, -2, "record_input");
+  lua->pushcclosure(L, replay_input, 0);
+  lua->setfield(L, -2, "replay_input");
+  lua->pushcclosure(L, stop_input, 0);
+  lua->setfield(L, -2, "stop_input");
+  lua->pushcclosure(L, get_input_status, 0);
+  lua->setfield(L, -2, "get_input_status");
+
+  // Logging
+  lua->pushcclosure(L, set_log_level, 0);
+  lua->setfield(L, -2, "set_log_level");
+  lua->pushcclosure(L, set_log_file, 0);
+  lua->setfield(L, -2, "set_log_file");
+
   // Fonts
   lua->pushcclosure(L, load_font, 0);
   lua->setfield(L, -2, "load_font");
+  lua->pushcclosure(L, font_ready, 0);
+  lua->setfield(L, -2, "font_ready");
   lua->pushcclosure(L, push_font, 0);
   lua->setfield(L, -2, "push_font");
   lua->pushcclosure(L, pop_font, 0);
@@ -1520,6 +1899,14 @@ void register_all(lua_State *L) {
   lua->pushcclosure(L, set_style, 0);
   lua->setfield(L, -2, "set_style");
 
+  // Command buffers
+  lua->pushcclosure(L, command_buffer::submit, 0);
+  lua->setfield(L, -2, "submit");
+  command_buffer::register_opcodes(L);
+
+  // FFI
+  ffi_api::register_all(L);
+
   // Set imgui table in ljeenv
   lua->setfield(L, -2, "imgui");
 
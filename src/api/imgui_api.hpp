@@ -5,4 +5,14 @@ namespace imgui_api {
 
 void register_all(lua_State *L);
 
+// Shared by the Lua and FFI bindings, so a window begun through one can be ended through
+// the other. Windows hidden with the overlay are not begun and return false.
+bool window_begin(const char *name, bool *open, int flags);
+void window_end();
+
+// TextColored, TextWrapped and SetTooltip over a text range, without going through the formatter
+void text_colored_unformatted(float r, float g, float b, float a, const char *begin, const char *end);
+void text_wrapped_unformatted(const char *begin, const char *end);
+void set_tooltip_unformatted(const char *begin, const char *end);
+
 } // namespace imgui_api
@@ -0,0 +1,130 @@
+#include "draw_optimizer.hpp"
+#include <cstring>
+#include <limits>
+
+namespace {
+
+constexpr uint32_t MAX_INDEX = std::numeric_limits<ImDrawIdx>::max();
+
+bool same_clip(const ImVec4 &a, const ImVec4 &b) {
+  return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w;
+}
+
+// Texture creation happens on the render thread, so compare the reference itself rather
+// than a resolved texture id
+bool same_texture(const ImTextureRef &a, const ImTextureRef &b) {
+  return a._TexData == b._TexData && a._TexID == b._TexID;
+}
+
+bool is_culled(const ImVec4 &clip, const ImDrawData *draw_data) {
+  float min_x = draw_data->DisplayPos.x;
+  float min_y = draw_data->DisplayPos.y;
+  float max_x = min_x + draw_data->DisplaySize.x;
+  float max_y = min_y + draw_data->DisplaySize.y;
+  return clip.z <= clip.x || clip.w <= clip.y ||
+         clip.z <= min_x || clip.w <= min_y || clip.x >= max_x || clip.y >= max_y;
+}
+
+} // namespace
+
+DrawOptimizer::~DrawOptimizer() {
+  release();
+}
+
+void DrawOptimizer::run(DrawSnapshot &snapshot) {
+  stats_ = {};
+  ImDrawData *draw_data = snapshot.data();
+  if (!draw_data->Valid || draw_data->CmdListsCount == 0)
+    return;
+
+  if (!merged_)
+    merged_ = IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData());
+
+  auto &cmds = merged_->CmdBuffer;
+  auto &idx = merged_->IdxBuffer;
+  auto &vtx = merged_->VtxBuffer;
+  cmds.resize(0);
+  idx.resize(0);
+  vtx.resize(0);
+  idx.reserve(draw_data->TotalIdxCount);
+  vtx.reserve(draw_data->TotalVtxCount);
+  merged_->Flags = draw_data->CmdLists[0]->Flags;
+
+  uint32_t window_base = 0; // Vertex the current output commands' indices are relative to
+  bool can_merge = false;   // The last output command is a draw that may be extended
+
+  for (const ImDrawList *list : draw_data->CmdLists) {
+    uint32_t list_base = static_cast<uint32_t>(vtx.Size);
+    vtx.resize(vtx.Size + list->VtxBuffer.Size);
+    if (list->VtxBuffer.Size > 0)
+      memcpy(vtx.Data + list_base, list->VtxBuffer.Data, list->VtxBuffer.size_in_bytes());
+
+    for (const ImDrawCmd &cmd : list->CmdBuffer) {
+      if (cmd.UserCallback) {
+        ImDrawCmd copy = cmd;
+        copy.VtxOffset = list_base + cmd.VtxOffset;
+        copy.IdxOffset = static_cast<unsigned int>(idx.Size);
+        cmds.push_back(copy);
+        can_merge = false;
+        continue;
+      }
+
+      stats_.commands++;
+      if (cmd.ElemCount == 0 || is_culled(cmd.ClipRect, draw_data)) {
+        stats_.culled++;
+        continue;
+      }
+
+      const ImDrawIdx *src = list->IdxBuffer.Data + cmd.IdxOffset;
+      uint32_t max_index = 0;
+      for (unsigned int i = 0; i < cmd.ElemCount; ++i) {
+        if (src[i] > max_index)
+          max_index = src[i];
+      }
+
+      // Start a new vertex window when the rebased indices would overflow
+      uint32_t src_base = list_base + cmd.VtxOffset;
+      if (src_base < window_base || src_base - window_base > MAX_INDEX - max_index) {
+        window_base = src_base;
+        can_merge = false;
+      }
+
+      uint32_t delta = src_base - window_base;
+      int idx_start = idx.Size;
+      idx.resize(idx.Size + static_cast<int>(cmd.ElemCount));
+      if (delta == 0) {
+        memcpy(idx.Data + idx_start, src, cmd.ElemCount * sizeof(ImDrawIdx));
+      } else {
+        for (unsigned int i = 0; i < cmd.ElemCount; ++i) {
+          idx.Data[idx_start + i] = static_cast<ImDrawIdx>(src[i] + delta);
+        }
+      }
+
+      if (can_merge) {
+        ImDrawCmd &last = cmds.back();
+        if (same_texture(last.TexRef, cmd.TexRef) && same_clip(last.ClipRect, cmd.ClipRect)) {
+          last.ElemCount += cmd.ElemCount;
+          stats_.merged++;
+          continue;
+        }
+      }
+
+      ImDrawCmd out = cmd;
+      out.VtxOffset = window_base;
+      out.IdxOffset = static_cast<unsigned int>(idx_start);
+      cmds.push_back(out);
+      can_merge = true;
+    }
+  }
+
+  stats_.draw_calls = stats_.commands - stats_.culled - stats_.merged;
+  snapshot.replace_lists(*merged_);
+}
+
+void DrawOptimizer::release() {
+  if (merged_) {
+    IM_DELETE(merged_);
+    merged_ = nullptr;
+  }
+  stats_ = {};
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <imgui.h>
+#include <cstdint>
+#include "draw_snapshot.hpp"
+
+// Post-Render pass over a captured frame. Concatenates every list into one combined
+// list, drops commands whose clip rect lies outside the display, and merges adjacent
+// commands with the same texture and clip rect into a single draw call. Indices are
+// rebased so merged commands share one vertex offset; a new offset is started whenever
+// the rebased indices would no longer fit in ImDrawIdx.
+//
+// User callbacks are kept in order, but receive the combined list as their parent.
+class DrawOptimizer {
+public:
+  struct Stats {
+    uint32_t commands = 0;   // Draw commands in the captured frame, callbacks excluded
+    uint32_t draw_calls = 0; // Draw commands left after the pass
+    uint32_t culled = 0;
+    uint32_t merged = 0;
+  };
+
+  DrawOptimizer() = default;
+  ~DrawOptimizer();
+
+  DrawOptimizer(const DrawOptimizer &) = delete;
+  DrawOptimizer &operator=(const DrawOptimizer &) = delete;
+
+  void run(DrawSnapshot &snapshot);
+
+  // Counts for the most recent run() call
+  const Stats &last_frame() const { return stats_; }
+
+  void release();
+
+private:
+  ImDrawList *merged_ = nullptr;
+  Stats stats_;
+};
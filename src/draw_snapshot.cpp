@@ -0,0 +1,138 @@
+#include "draw_snapshot.hpp"
+#include <cstring>
+
+namespace {
+
+// ImVector's copy assignment frees and reallocates, resize() keeps the old capacity
+template<typename T>
+void copy_into(ImVector<T> &dst, const ImVector<T> &src) {
+  dst.resize(src.Size);
+  if (src.Size > 0) {
+    memcpy(dst.Data, src.Data, src.size_in_bytes());
+  }
+}
+
+// Word-at-a-time FNV-style mix, good enough to tell frames apart
+uint64_t hash_bytes(uint64_t h, const void *data, size_t size) {
+  constexpr uint64_t PRIME = 0x100000001b3ull;
+  auto p = static_cast<const uint8_t *>(data);
+  for (; size >= 8; size -= 8, p += 8) {
+    uint64_t word;
+    memcpy(&word, p, 8);
+    h = (h ^ word) * PRIME;
+  }
+  for (; size > 0; --size, ++p) {
+    h = (h ^ *p) * PRIME;
+  }
+  return h;
+}
+
+} // namespace
+
+DrawSnapshot::~DrawSnapshot() {
+  release();
+}
+
+void DrawSnapshot::capture(const ImDrawData *src) {
+  begin(src);
+  if (!data_.Valid)
+    return;
+
+  for (const ImDrawList *list : src->CmdLists) {
+    add(list);
+  }
+}
+
+void DrawSnapshot::begin(const ImDrawData *src) {
+  data_.Clear();
+  if (!src || !src->Valid)
+    return;
+
+  data_.Valid = true;
+  data_.DisplayPos = src->DisplayPos;
+  data_.DisplaySize = src->DisplaySize;
+  data_.FramebufferScale = src->FramebufferScale;
+  data_.OwnerViewport = src->OwnerViewport;
+}
+
+void DrawSnapshot::add(const ImDrawList *list) {
+  if (lists_.Size <= data_.CmdListsCount) {
+    lists_.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+  }
+
+  ImDrawList *to = lists_[data_.CmdListsCount];
+  copy_into(to->CmdBuffer, list->CmdBuffer);
+  copy_into(to->IdxBuffer, list->IdxBuffer);
+  copy_into(to->VtxBuffer, list->VtxBuffer);
+  to->Flags = list->Flags;
+
+  data_.CmdLists.push_back(to);
+  data_.CmdListsCount++;
+  data_.TotalIdxCount += list->IdxBuffer.Size;
+  data_.TotalVtxCount += list->VtxBuffer.Size;
+}
+
+void DrawSnapshot::add(const DrawSnapshot &other) {
+  for (const ImDrawList *list : other.data_.CmdLists) {
+    add(list);
+  }
+}
+
+void DrawSnapshot::replace_lists(ImDrawList &list) {
+  if (lists_.Size == 0) {
+    lists_.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+  }
+
+  ImDrawList *to = lists_[0];
+  to->CmdBuffer.swap(list.CmdBuffer);
+  to->IdxBuffer.swap(list.IdxBuffer);
+  to->VtxBuffer.swap(list.VtxBuffer);
+  to->Flags = list.Flags;
+
+  data_.CmdLists.resize(0);
+  data_.CmdLists.push_back(to);
+  data_.CmdListsCount = 1;
+  data_.TotalIdxCount = to->IdxBuffer.Size;
+  data_.TotalVtxCount = to->VtxBuffer.Size;
+}
+
+uint64_t DrawSnapshot::hash() const {
+  uint64_t h = 0xcbf29ce484222325ull;
+  for (const ImDrawList *list : data_.CmdLists) {
+    h = hash_bytes(h, list->CmdBuffer.Data, list->CmdBuffer.size_in_bytes());
+    h = hash_bytes(h, list->VtxBuffer.Data, list->VtxBuffer.size_in_bytes());
+    h = hash_bytes(h, list->IdxBuffer.Data, list->IdxBuffer.size_in_bytes());
+  }
+  return h;
+}
+
+void DrawSnapshot::release() {
+  data_.Clear();
+  for (ImDrawList *list : lists_) {
+    IM_DELETE(list);
+  }
+  lists_.clear();
+  requests_.clear();
+  requests_applied_ = true;
+}
+
+void SnapshotBuffer::publish() {
+  write_ = middle_.exchange(write_ | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+}
+
+bool SnapshotBuffer::acquire() {
+  if (!(middle_.load(std::memory_order_acquire) & FRESH))
+    return false;
+
+  read_ = middle_.exchange(read_, std::memory_order_acq_rel) & INDEX_MASK;
+  return true;
+}
+
+void SnapshotBuffer::release() {
+  for (auto &slot : slots_) {
+    slot.release();
+  }
+  middle_ = 1;
+  write_ = 0;
+  read_ = 2;
+}
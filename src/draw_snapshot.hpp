@@ -0,0 +1,91 @@
+#pragma once
+#include <imgui.h>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Device work for one ImGui texture, copied out of the live ImTextureData on the Lua thread
+// by TextureSync. The render thread applies it to proxy, an ImTextureData only it reads
+// once handed over, and reports back through applied and tex_id.
+struct TextureRequest {
+  ImTextureData *proxy = nullptr;
+  ImTextureStatus status = ImTextureStatus_OK; // WantCreate, WantUpdates or WantDestroy
+  int width = 0;
+  int height = 0;
+  std::vector<ImTextureRect> rects;  // WantUpdates
+  std::vector<unsigned char> pixels; // RGBA32, the whole texture or the rects back to back
+
+  // Render thread
+  bool applied = false;
+  ImTextureID tex_id = ImTextureID_Invalid;
+};
+
+// Deep copy of a finished ImDrawData. The copied draw lists and their buffers are kept
+// between captures, so once a snapshot has grown to fit the UI it stops allocating.
+class DrawSnapshot {
+public:
+  DrawSnapshot() = default;
+  ~DrawSnapshot();
+
+  DrawSnapshot(const DrawSnapshot &) = delete;
+  DrawSnapshot &operator=(const DrawSnapshot &) = delete;
+
+  void capture(const ImDrawData *src);
+
+  // Piecewise capture: begin() takes the display metadata of src, add() appends a copy of
+  // one list. Used when a frame is stitched together from live and cached lists.
+  // Textures is left null, the renderer only gets textures through TextureRequests.
+  void begin(const ImDrawData *src);
+  void add(const ImDrawList *list);
+  void add(const DrawSnapshot &other);
+
+  // Makes list the only list of the snapshot by swapping buffers with it, list gets the
+  // old buffers back for reuse
+  void replace_lists(ImDrawList &list);
+
+  void release();
+
+  // Cheap content hash over commands, vertices and indices, for change detection
+  uint64_t hash() const;
+
+  ImDrawData *data() { return &data_; }
+
+  // Texture requests travel with the frame, the reader applies them before drawing it.
+  // Requests of a slot the reader skipped were never applied and stay for the next publish.
+  std::vector<TextureRequest> &texture_requests() { return requests_; }
+  bool requests_applied() const { return requests_applied_; }
+  void set_requests_applied(bool applied) { requests_applied_ = applied; }
+
+private:
+  ImDrawData data_;
+  ImVector<ImDrawList *> lists_;
+  std::vector<TextureRequest> requests_;
+  bool requests_applied_ = true;
+};
+
+// Lock-free triple buffer between the Lua thread (writer) and the D3D thread (reader).
+// The writer always has a slot to fill and the reader always has a complete slot to
+// draw; publishing and acquiring are a single atomic exchange, so neither side waits.
+class SnapshotBuffer {
+public:
+  DrawSnapshot &write_slot() { return slots_[write_]; }
+  DrawSnapshot &read_slot() { return slots_[read_]; }
+
+  // Writer: hand the filled write slot over to the reader
+  void publish();
+
+  // Reader: swap in the newest published slot, returns false if nothing new was published
+  bool acquire();
+
+  // Frees all snapshot memory, must not race with either side
+  void release();
+
+private:
+  static constexpr uint8_t INDEX_MASK = 0x3;
+  static constexpr uint8_t FRESH = 0x4;
+
+  DrawSnapshot slots_[3];
+  std::atomic<uint8_t> middle_ = 1;
+  uint8_t write_ = 0; // Owned by the writer
+  uint8_t read_ = 2;  // Owned by the reader
+};
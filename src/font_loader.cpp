@@ -0,0 +1,207 @@
+#include "font_loader.hpp"
+#include "log.hpp"
+#include <Windows.h>
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+namespace {
+
+constexpr unsigned MAX_WORKERS = 4;
+
+// Paths from Lua are UTF-8
+std::wstring widen(const std::string &path) {
+  int len = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+  if (len <= 1)
+    return {};
+
+  std::wstring wide(static_cast<size_t>(len - 1), L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, wide.data(), len);
+  return wide;
+}
+
+} // namespace
+
+struct FontFile {
+  std::string path;
+  uint64_t size = 0;
+  uint64_t write_time = 0;
+  HANDLE mapping = nullptr;
+  void *view = nullptr;
+
+  ~FontFile() {
+    if (view)
+      UnmapViewOfFile(view);
+    if (mapping)
+      CloseHandle(mapping);
+  }
+};
+
+FontLoader::~FontLoader() {
+  release();
+}
+
+FontLoader::Handle *FontLoader::load(const char *path, float size) {
+  for (const auto &existing : handles_) {
+    if (existing->size == size && existing->path == path && existing->status != Status::Failed)
+      return existing.get();
+  }
+
+  auto handle = std::make_unique<Handle>();
+  handle->path = path;
+  handle->size = size;
+  Handle *ptr = handle.get();
+  handles_.push_back(std::move(handle));
+  uncommitted_.push_back(ptr);
+
+  ensure_workers();
+  {
+    std::lock_guard lock(mutex_);
+    queue_.push_back(ptr);
+  }
+  cv_.notify_one();
+  return ptr;
+}
+
+void FontLoader::commit() {
+  if (uncommitted_.empty())
+    return;
+
+  ImGuiIO &io = ImGui::GetIO();
+  auto it = std::remove_if(uncommitted_.begin(), uncommitted_.end(), [&io](Handle *handle) {
+    if (!handle->read.load(std::memory_order_acquire))
+      return handle->status == Status::Failed;
+
+    ImFontConfig config;
+    config.FontDataOwnedByAtlas = false;
+    handle->font = io.Fonts->AddFontFromMemoryTTF(handle->file->view, static_cast<int>(handle->file->size),
+                                                  handle->size, &config);
+    if (!handle->font) {
+      logger::error("Failed to load font %s", handle->path.c_str());
+      handle->status = Status::Failed;
+      return true;
+    }
+
+    if (handle->make_default)
+      io.FontDefault = handle->font;
+    handle->status = Status::Ready;
+    return true;
+  });
+  uncommitted_.erase(it, uncommitted_.end());
+}
+
+FontLoader::Handle *FontLoader::find(void *ptr) const {
+  for (const auto &handle : handles_) {
+    if (handle.get() == ptr)
+      return handle.get();
+  }
+  return nullptr;
+}
+
+ImFont *FontLoader::resolve(void *ptr) const {
+  if (Handle *handle = find(ptr))
+    return handle->font;
+  return static_cast<ImFont *>(ptr);
+}
+
+void FontLoader::release() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+    queue_.clear();
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+  stopping_ = false;
+
+  uncommitted_.clear();
+  handles_.clear();
+  files_.clear();
+}
+
+void FontLoader::ensure_workers() {
+  unsigned wanted = std::clamp(std::thread::hardware_concurrency() / 2, 1u, MAX_WORKERS);
+  if (workers_.size() >= wanted || workers_.size() >= uncommitted_.size())
+    return;
+  workers_.emplace_back(&FontLoader::worker_func, this);
+}
+
+void FontLoader::worker_func() {
+  for (;;) {
+    Handle *handle;
+    {
+      std::unique_lock lock(mutex_);
+      cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      if (stopping_)
+        return;
+      handle = queue_.front();
+      queue_.pop_front();
+    }
+
+    handle->file = map_file(handle->path);
+    if (handle->file) {
+      handle->read.store(true, std::memory_order_release);
+    } else {
+      logger::error("Failed to read font %s", handle->path.c_str());
+      handle->status = Status::Failed;
+    }
+  }
+}
+
+std::shared_ptr<FontFile> FontLoader::map_file(const std::string &path) {
+  std::wstring wide = widen(path);
+  if (wide.empty())
+    return nullptr;
+
+  HANDLE file = CreateFileW(wide.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return nullptr;
+
+  BY_HANDLE_FILE_INFORMATION info;
+  if (!GetFileInformationByHandle(file, &info)) {
+    CloseHandle(file);
+    return nullptr;
+  }
+
+  uint64_t size = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+  uint64_t write_time = (static_cast<uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) |
+                        info.ftLastWriteTime.dwLowDateTime;
+  if (size == 0 || size > INT_MAX) {
+    CloseHandle(file);
+    return nullptr;
+  }
+
+  // Same file loaded at another size, or by another worker meanwhile
+  {
+    std::lock_guard lock(mutex_);
+    for (const auto &weak : files_) {
+      auto mapped = weak.lock();
+      if (mapped && mapped->path == path && mapped->size == size && mapped->write_time == write_time) {
+        CloseHandle(file);
+        return mapped;
+      }
+    }
+  }
+
+  auto mapped = std::make_shared<FontFile>();
+  mapped->path = path;
+  mapped->size = size;
+  mapped->write_time = write_time;
+  mapped->mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file); // The mapping keeps the file open
+  if (!mapped->mapping)
+    return nullptr;
+
+  mapped->view = MapViewOfFile(mapped->mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!mapped->view)
+    return nullptr;
+
+  std::lock_guard lock(mutex_);
+  std::erase_if(files_, [](const auto &weak) { return weak.expired(); });
+  files_.push_back(mapped);
+  return mapped;
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <imgui.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Read-only memory mapping of a font file, shared by every font loaded from it
+struct FontFile;
+
+// Loads fonts without stalling the Lua frame. load() returns a handle right away, worker
+// threads map the font files in parallel, and commit() adds the finished ones to the
+// atlas at the next frame boundary. With ImGuiBackendFlags_RendererHasTextures the atlas
+// rasterizes glyphs on demand and the renderer uploads only the changed regions, so no
+// atlas rebuild or device object invalidation is needed anymore.
+//
+// Files are mapped once per path, size and write time, and loading the same path at the
+// same size again returns the existing handle.
+class FontLoader {
+public:
+  enum class Status { Pending, Ready, Failed };
+
+  struct Handle {
+    std::string path;
+    float size = 0.0f;
+    std::atomic<Status> status = Status::Pending;
+    std::atomic<bool> read = false; // File is mapped, set by the worker
+    std::shared_ptr<FontFile> file; // Stays mapped for the atlas, which does not own the data
+    ImFont *font = nullptr;         // Lua thread only, set once committed
+    bool make_default = false;
+  };
+
+  FontLoader() = default;
+  ~FontLoader();
+
+  FontLoader(const FontLoader &) = delete;
+  FontLoader &operator=(const FontLoader &) = delete;
+
+  Handle *load(const char *path, float size);
+
+  // Adds every font read since the last call to the atlas. Lua thread, outside a frame.
+  void commit();
+
+  // Handle pointer to its font once ready, other pointers are taken to be ImFont already
+  ImFont *resolve(void *ptr) const;
+  Handle *find(void *ptr) const;
+
+  // Stops the workers and frees all handles, after the ImGui context is destroyed
+  void release();
+
+private:
+  void worker_func();
+  void ensure_workers();
+  std::shared_ptr<FontFile> map_file(const std::string &path);
+
+  std::vector<std::unique_ptr<Handle>> handles_; // Lua thread only
+  std::vector<Handle *> uncommitted_;             // Lua thread only
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Handle *> queue_;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+  std::vector<std::weak_ptr<FontFile>> files_; // Guarded by mutex_
+};
@@ -0,0 +1,56 @@
+#include "id_cache.hpp"
+#include <imgui_internal.h>
+#include <cstring>
+
+ImGuiID IdCache::get(const char *str, size_t len) {
+  ImGuiWindow *window = ImGui::GetCurrentWindow();
+  Key key{str, len, window->IDStack.back()};
+
+  auto it = entries_.find(key);
+  if (it != entries_.end() && it->second.text.size() == len && memcmp(it->second.text.data(), str, len) == 0) {
+    it->second.frame = frame_;
+    hits_++;
+    return it->second.id;
+  }
+
+  misses_++;
+  ImGuiID id = window->GetID(str, str + len);
+  if (it != entries_.end()) {
+    // Address reused by another string
+    it->second = {id, frame_, std::string(str, len)};
+  } else if (entries_.size() < MAX_ENTRIES) {
+    entries_.emplace(key, Entry{id, frame_, std::string(str, len)});
+  }
+  return id;
+}
+
+void IdCache::new_frame() {
+  frame_++;
+  if (frame_ % SWEEP_INTERVAL == 0 || entries_.size() >= MAX_ENTRIES)
+    sweep(entries_.size() >= MAX_ENTRIES ? 1 : SWEEP_AFTER_FRAMES);
+}
+
+void IdCache::clear() {
+  evicted_ += entries_.size();
+  entries_.clear();
+}
+
+IdCache::Stats IdCache::stats() const {
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.evicted = evicted_;
+  stats.entries = entries_.size();
+  return stats;
+}
+
+void IdCache::sweep(uint32_t max_age) {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (frame_ - it->second.frame > max_age) {
+      it = entries_.erase(it);
+      evicted_++;
+    } else {
+      ++it;
+    }
+  }
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <imgui.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// Label -> ImGuiID lookups keyed by the interned Lua string's address, its length and
+// the current ID stack seed, so labels that repeat every frame are hashed once. A hit is
+// confirmed against a copy of the label, since a collected string's address can be reused.
+// Entries unused for SWEEP_AFTER_FRAMES are dropped and the table is capped at
+// MAX_ENTRIES. Lua thread only, inside a frame.
+class IdCache {
+public:
+  static constexpr size_t MAX_ENTRIES = 4096;
+  static constexpr uint32_t SWEEP_AFTER_FRAMES = 120;
+  static constexpr uint32_t SWEEP_INTERVAL = 60;
+
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evicted = 0;
+    size_t entries = 0;
+  };
+
+  // Same result as ImGui::GetID(str) in the current window
+  ImGuiID get(const char *str, size_t len);
+
+  // Advances the generation and sweeps stale entries every SWEEP_INTERVAL frames
+  void new_frame();
+  void clear();
+
+  Stats stats() const;
+
+private:
+  struct Key {
+    const char *str;
+    size_t len;
+    ImGuiID seed;
+    bool operator==(const Key &) const = default;
+  };
+
+  struct KeyHash {
+    size_t operator()(const Key &key) const {
+      // The address is unique enough, mixing in the seed keeps one label in many scopes apart
+      auto h = reinterpret_cast<uintptr_t>(key.str) * 0x9E3779B97F4A7C15ull;
+      return static_cast<size_t>(h ^ (static_cast<uint64_t>(key.seed) << 16) ^ key.len);
+    }
+  };
+
+  struct Entry {
+    ImGuiID id;
+    uint32_t frame;
+    std::string text;
+  };
+
+  void sweep(uint32_t max_age);
+
+  std::unordered_map<Key, Entry, KeyHash> entries_;
+  uint32_t frame_ = 0;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+  uint64_t evicted_ = 0;
+};
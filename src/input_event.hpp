@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+
+// An ImGui input event, translated from a window message on the window thread. Kept free
+// of Windows headers, so recordings can be read without a window.
+struct InputEvent {
+  enum class Type : uint8_t { MousePos, MouseButton, MouseWheel, Key, Char, Focus };
+
+  // Modifier keys held when a Key event was queued
+  static constexpr uint8_t MOD_CTRL = 1;
+  static constexpr uint8_t MOD_SHIFT = 2;
+  static constexpr uint8_t MOD_ALT = 4;
+  static constexpr uint8_t MOD_SUPER = 8;
+
+  Type type;
+  uint8_t source;    // ImGuiMouseSource of MousePos and MouseButton
+  uint8_t mods;      // Key: MOD_* flags
+  bool down;         // Key and MouseButton: pressed, Focus: gained
+  uint16_t key;      // Key: ImGuiKey, MouseButton: button index, Char: UTF-16 code unit
+  uint16_t vk;       // Key: virtual key
+  uint16_t scancode; // Key
+  float x;           // MousePos: position, MouseWheel: horizontal and vertical delta
+  float y;
+};
@@ -0,0 +1,266 @@
+#include "input_queue.hpp"
+#include <imgui.h>
+#include <windowsx.h>
+#include <cfloat>
+
+// Defined by the Win32 backend, without a declaration in its header
+ImGuiKey ImGui_ImplWin32_KeyEventToImGuiKey(WPARAM wparam, LPARAM lparam);
+
+namespace {
+
+bool is_vk_down(int vk) {
+  return (GetKeyState(vk) & 0x8000) != 0;
+}
+
+uint8_t key_mods() {
+  uint8_t mods = 0;
+  mods |= is_vk_down(VK_CONTROL) ? InputEvent::MOD_CTRL : 0;
+  mods |= is_vk_down(VK_SHIFT) ? InputEvent::MOD_SHIFT : 0;
+  mods |= is_vk_down(VK_MENU) ? InputEvent::MOD_ALT : 0;
+  mods |= is_vk_down(VK_LWIN) || is_vk_down(VK_RWIN) ? InputEvent::MOD_SUPER : 0;
+  return mods;
+}
+
+// Pen and touch input is tagged through the message's extra info
+uint8_t mouse_source() {
+  LPARAM extra_info = GetMessageExtraInfo();
+  if ((extra_info & 0xFFFFFF80) == 0xFF515700)
+    return ImGuiMouseSource_Pen;
+  if ((extra_info & 0xFFFFFF80) == 0xFF515780)
+    return ImGuiMouseSource_TouchScreen;
+  return ImGuiMouseSource_Mouse;
+}
+
+int mouse_button(UINT msg, WPARAM wparam) {
+  switch (msg) {
+  case WM_LBUTTONDOWN:
+  case WM_LBUTTONDBLCLK:
+  case WM_LBUTTONUP:
+    return 0;
+  case WM_RBUTTONDOWN:
+  case WM_RBUTTONDBLCLK:
+  case WM_RBUTTONUP:
+    return 1;
+  case WM_MBUTTONDOWN:
+  case WM_MBUTTONDBLCLK:
+  case WM_MBUTTONUP:
+    return 2;
+  default:
+    return GET_XBUTTON_WPARAM(wparam) == XBUTTON1 ? 3 : 4;
+  }
+}
+
+UINT keyboard_code_page() {
+  UINT code_page = 0;
+  LCID lcid = MAKELCID(HIWORD(GetKeyboardLayout(0)), SORT_DEFAULT);
+  if (GetLocaleInfoA(lcid, LOCALE_RETURN_NUMBER | LOCALE_IDEFAULTANSICODEPAGE, reinterpret_cast<LPSTR>(&code_page),
+                     sizeof(code_page)) == 0)
+    return CP_ACP;
+  return code_page;
+}
+
+} // namespace
+
+// Mirrors what ImGui_ImplWin32_WndProcHandler does with each message, minus gamepads
+void InputQueue::push_message(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) {
+  Event event = {};
+  switch (msg) {
+  case WM_MOUSEMOVE:
+  case WM_NCMOUSEMOVE: {
+    // Tracking is what makes Windows send WM_MOUSELEAVE
+    int area = msg == WM_MOUSEMOVE ? 1 : 2;
+    if (mouse_tracked_area_ != area) {
+      TRACKMOUSEEVENT cancel = {sizeof(cancel), TME_CANCEL, hwnd, 0};
+      TRACKMOUSEEVENT track = {sizeof(track), static_cast<DWORD>(area == 2 ? TME_LEAVE | TME_NONCLIENT : TME_LEAVE),
+                               hwnd, 0};
+      if (mouse_tracked_area_ != 0)
+        TrackMouseEvent(&cancel);
+      TrackMouseEvent(&track);
+      mouse_tracked_area_ = area;
+    }
+    POINT pos = {GET_X_LPARAM(lparam), GET_Y_LPARAM(lparam)};
+    if (msg == WM_NCMOUSEMOVE && !ScreenToClient(hwnd, &pos))
+      return;
+    event.type = Type::MousePos;
+    event.source = mouse_source();
+    event.x = static_cast<float>(pos.x);
+    event.y = static_cast<float>(pos.y);
+    push(event);
+    return;
+  }
+  case WM_MOUSELEAVE:
+  case WM_NCMOUSELEAVE:
+    if (mouse_tracked_area_ != (msg == WM_MOUSELEAVE ? 1 : 2))
+      return;
+    mouse_tracked_area_ = 0;
+    event.type = Type::MousePos;
+    event.source = ImGuiMouseSource_Mouse;
+    event.x = -FLT_MAX;
+    event.y = -FLT_MAX;
+    push(event);
+    return;
+  case WM_LBUTTONDOWN:
+  case WM_LBUTTONDBLCLK:
+  case WM_RBUTTONDOWN:
+  case WM_RBUTTONDBLCLK:
+  case WM_MBUTTONDOWN:
+  case WM_MBUTTONDBLCLK:
+  case WM_XBUTTONDOWN:
+  case WM_XBUTTONDBLCLK:
+  case WM_LBUTTONUP:
+  case WM_RBUTTONUP:
+  case WM_MBUTTONUP:
+  case WM_XBUTTONUP: {
+    int button = mouse_button(msg, wparam);
+    bool down = msg != WM_LBUTTONUP && msg != WM_RBUTTONUP && msg != WM_MBUTTONUP && msg != WM_XBUTTONUP;
+    // Capture keeps drags going outside the window
+    if (down) {
+      if (mouse_buttons_down_ == 0 && GetCapture() == nullptr) {
+        SetCapture(hwnd);
+        captured_ = true;
+      }
+      mouse_buttons_down_ |= 1 << button;
+    } else {
+      mouse_buttons_down_ &= ~(1 << button);
+      if (mouse_buttons_down_ == 0 && captured_) {
+        if (GetCapture() == hwnd)
+          ReleaseCapture();
+        captured_ = false;
+      }
+    }
+    event.type = Type::MouseButton;
+    event.source = mouse_source();
+    event.down = down;
+    event.key = static_cast<uint16_t>(button);
+    push(event);
+    return;
+  }
+  case WM_MOUSEWHEEL:
+  case WM_MOUSEHWHEEL: {
+    float delta = static_cast<float>(GET_WHEEL_DELTA_WPARAM(wparam)) / WHEEL_DELTA;
+    event.type = Type::MouseWheel;
+    event.x = msg == WM_MOUSEHWHEEL ? -delta : 0.0f;
+    event.y = msg == WM_MOUSEWHEEL ? delta : 0.0f;
+    push(event);
+    return;
+  }
+  case WM_KEYDOWN:
+  case WM_KEYUP:
+  case WM_SYSKEYDOWN:
+  case WM_SYSKEYUP: {
+    if (wparam >= 256)
+      return;
+    bool down = msg == WM_KEYDOWN || msg == WM_SYSKEYDOWN;
+    int vk = static_cast<int>(wparam);
+    int scancode = LOBYTE(HIWORD(lparam));
+    uint8_t mods = key_mods();
+    auto key = static_cast<uint16_t>(ImGui_ImplWin32_KeyEventToImGuiKey(wparam, lparam));
+
+    // Windows only sends the release of PrintScreen
+    if (key == ImGuiKey_PrintScreen && !down)
+      push_key(vk, scancode, true, key, mods);
+    push_key(vk, scancode, down, key, mods);
+
+    // The generic modifier keys also report which side changed
+    if (vk == VK_SHIFT) {
+      if (is_vk_down(VK_LSHIFT) == down)
+        push_key(VK_LSHIFT, scancode, down, ImGuiKey_LeftShift, mods);
+      if (is_vk_down(VK_RSHIFT) == down)
+        push_key(VK_RSHIFT, scancode, down, ImGuiKey_RightShift, mods);
+    } else if (vk == VK_CONTROL) {
+      if (is_vk_down(VK_LCONTROL) == down)
+        push_key(VK_LCONTROL, scancode, down, ImGuiKey_LeftCtrl, mods);
+      if (is_vk_down(VK_RCONTROL) == down)
+        push_key(VK_RCONTROL, scancode, down, ImGuiKey_RightCtrl, mods);
+    } else if (vk == VK_MENU) {
+      if (is_vk_down(VK_LMENU) == down)
+        push_key(VK_LMENU, scancode, down, ImGuiKey_LeftAlt, mods);
+      if (is_vk_down(VK_RMENU) == down)
+        push_key(VK_RMENU, scancode, down, ImGuiKey_RightAlt, mods);
+    }
+    return;
+  }
+  case WM_CHAR: {
+    wchar_t ch = 0;
+    if (IsWindowUnicode(hwnd)) {
+      if (wparam == 0 || wparam >= 0x10000)
+        return;
+      ch = static_cast<wchar_t>(wparam);
+    } else {
+      if (code_page_ == 0)
+        code_page_ = keyboard_code_page();
+      char byte = static_cast<char>(wparam);
+      if (MultiByteToWideChar(code_page_, MB_PRECOMPOSED, &byte, 1, &ch, 1) != 1)
+        return;
+    }
+    event.type = Type::Char;
+    event.key = static_cast<uint16_t>(ch);
+    push(event);
+    return;
+  }
+  case WM_INPUTLANGCHANGE:
+    code_page_ = keyboard_code_page();
+    return;
+  case WM_SETFOCUS:
+  case WM_KILLFOCUS:
+    event.type = Type::Focus;
+    event.down = msg == WM_SETFOCUS;
+    push(event);
+    return;
+  default:
+    return;
+  }
+}
+
+void InputQueue::reset_mouse(HWND hwnd) {
+  if (captured_ && GetCapture() == hwnd)
+    ReleaseCapture();
+  captured_ = false;
+  mouse_buttons_down_ = 0;
+  mouse_tracked_area_ = 0; // WM_MOUSELEAVE may go unseen too
+}
+
+void InputQueue::push_key(int vk, int scancode, bool down, uint16_t key, uint8_t mods) {
+  Event event = {};
+  event.type = Type::Key;
+  event.mods = mods;
+  event.down = down;
+  event.key = key;
+  event.vk = static_cast<uint16_t>(vk);
+  event.scancode = static_cast<uint16_t>(scancode);
+  push(event);
+}
+
+bool InputQueue::push(const Event &event) {
+  size_t head = head_.load(std::memory_order_relaxed);
+  if (head - tail_.load(std::memory_order_acquire) >= CAPACITY) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  ring_[head % CAPACITY] = event;
+  head_.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+void InputQueue::drain(std::vector<Event> &out) {
+  size_t tail = tail_.load(std::memory_order_relaxed);
+  size_t head = head_.load(std::memory_order_acquire);
+
+  for (; tail != head; ++tail) {
+    const Event &event = ring_[tail % CAPACITY];
+    Event *last = out.empty() ? nullptr : &out.back();
+    bool same = last && last->type == event.type;
+
+    if (same && event.type == Type::MousePos) {
+      *last = event;
+    } else if (same && event.type == Type::MouseWheel) {
+      last->x += event.x;
+      last->y += event.y;
+    } else {
+      out.push_back(event);
+    }
+  }
+
+  tail_.store(tail, std::memory_order_release);
+}
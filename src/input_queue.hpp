@@ -0,0 +1,54 @@
+#pragma once
+#include <Windows.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "input_event.hpp"
+
+// Single-producer single-consumer queue of ImGui input events. The window thread
+// translates its messages in wndproc, where GetKeyState, GetMessageExtraInfo and
+// TrackMouseEvent see that thread's input state, and the frame-building thread applies
+// the events to ImGuiIO before NewFrame, so the ImGui context is only ever touched by one
+// thread.
+class InputQueue {
+public:
+  using Event = InputEvent;
+  using Type = InputEvent::Type;
+
+  static constexpr size_t CAPACITY = 1024;
+
+  // Window thread: translates a message ImGui's Win32 backend would consume and queues the
+  // resulting events, counting them as dropped when the queue is full. WM_SETCURSOR is
+  // left to the game and other messages are ignored.
+  void push_message(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam);
+
+  // Window thread, while messages aren't pushed: lets go of the mouse capture taken for a
+  // drag and forgets the mouse tracking, their ending messages would never be seen
+  void reset_mouse(HWND hwnd);
+
+  // Frame thread: appends every queued event to out, merging consecutive mouse moves into
+  // the last one and consecutive wheel events into one with the summed delta
+  void drain(std::vector<Event> &out);
+
+  // Frame thread: drops everything queued so far
+  void discard() { tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release); }
+
+  // Frame thread: events lost to a full queue since the last call
+  uint32_t take_dropped() { return dropped_.exchange(0, std::memory_order_relaxed); }
+
+private:
+  bool push(const Event &event);
+  void push_key(int vk, int scancode, bool down, uint16_t key, uint8_t mods);
+
+  Event ring_[CAPACITY] = {};
+  alignas(64) std::atomic<size_t> head_ = 0; // Written by the producer
+  alignas(64) std::atomic<size_t> tail_ = 0; // Written by the consumer
+  std::atomic<uint32_t> dropped_ = 0;
+
+  // Window thread only
+  int mouse_tracked_area_ = 0; // 1 client, 2 non-client, as tracked by TrackMouseEvent
+  int mouse_buttons_down_ = 0;
+  bool captured_ = false; // SetCapture was ours
+  UINT code_page_ = 0; // Of the keyboard layout, for WM_CHAR on ANSI windows, 0 until known
+};
@@ -0,0 +1,204 @@
+#include "input_recorder.hpp"
+#include "log.hpp"
+#include <cstring>
+
+namespace {
+
+constexpr char MAGIC[8] = {'L', 'J', 'E', 'I', 'N', 'P', 'T', '2'};
+constexpr size_t FRAME_SIZE = 5 * 4;
+constexpr size_t EVENT_SIZE = 4 + 4 * 2 + 2 * 4;
+
+void put_u16(uint8_t *p, uint16_t v) {
+  memcpy(p, &v, 2);
+}
+
+void put_u32(uint8_t *p, uint32_t v) {
+  memcpy(p, &v, 4);
+}
+
+void put_f32(uint8_t *p, float v) {
+  memcpy(p, &v, 4);
+}
+
+uint16_t get_u16(const uint8_t *p) {
+  uint16_t v;
+  memcpy(&v, p, 2);
+  return v;
+}
+
+uint32_t get_u32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
+}
+
+float get_f32(const uint8_t *p) {
+  float v;
+  memcpy(&v, p, 4);
+  return v;
+}
+
+} // namespace
+
+InputRecorder::~InputRecorder() {
+  stop();
+}
+
+bool InputRecorder::start_recording(const std::string &path) {
+  stop();
+
+  file_ = fopen(path.c_str(), "wb");
+  if (!file_ || fwrite(MAGIC, sizeof(MAGIC), 1, file_) != 1) {
+    logger::error("Failed to open input recording %s", path.c_str());
+    stop();
+    return false;
+  }
+
+  mode_ = Mode::Recording;
+  frame_ = 0;
+  logger::info("Recording input to %s", path.c_str());
+  return true;
+}
+
+bool InputRecorder::start_replay(const std::string &path) {
+  stop();
+
+  FILE *f = fopen(path.c_str(), "rb");
+  if (!f) {
+    logger::error("Failed to open input recording %s", path.c_str());
+    return false;
+  }
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  if (size > 0) {
+    data_.resize(static_cast<size_t>(size));
+    if (fread(data_.data(), 1, data_.size(), f) != data_.size())
+      data_.clear();
+  }
+  fclose(f);
+
+  if (data_.size() < sizeof(MAGIC) || memcmp(data_.data(), MAGIC, sizeof(MAGIC)) != 0) {
+    logger::error("%s is not an input recording", path.c_str());
+    data_.clear();
+    return false;
+  }
+
+  // Count the complete frames, a recording cut short by a crash still replays up to there
+  frame_count_ = 0;
+  size_t offset = sizeof(MAGIC);
+  while (offset + FRAME_SIZE <= data_.size()) {
+    // Checked against what is left first, count * EVENT_SIZE can wrap a 32-bit size_t
+    uint32_t count = get_u32(data_.data() + offset + 16);
+    if (count > (data_.size() - offset - FRAME_SIZE) / EVENT_SIZE)
+      break;
+    offset += FRAME_SIZE + count * EVENT_SIZE;
+    frame_count_++;
+  }
+  data_.resize(offset);
+
+  mode_ = Mode::Replaying;
+  offset_ = sizeof(MAGIC);
+  frame_ = 0;
+  logger::info("Replaying %u frames of input from %s", frame_count_, path.c_str());
+  return true;
+}
+
+void InputRecorder::stop() {
+  if (mode_ == Mode::Recording)
+    logger::info("Recorded %u frames of input", frame_);
+  if (file_) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+  data_.clear();
+  data_.shrink_to_fit();
+  offset_ = 0;
+  frame_count_ = 0;
+  mode_ = Mode::Idle;
+}
+
+void InputRecorder::record(const std::vector<InputEvent> &events, float delta_time, float width, float height) {
+  if (mode_ != Mode::Recording)
+    return;
+
+  uint8_t header[FRAME_SIZE];
+  put_u32(header, frame_);
+  put_f32(header + 4, delta_time);
+  put_f32(header + 8, width);
+  put_f32(header + 12, height);
+  put_u32(header + 16, static_cast<uint32_t>(events.size()));
+  bool ok = fwrite(header, sizeof(header), 1, file_) == 1;
+
+  for (const auto &event : events) {
+    uint8_t bytes[EVENT_SIZE] = {};
+    bytes[0] = static_cast<uint8_t>(event.type);
+    bytes[1] = event.source;
+    bytes[2] = event.mods;
+    bytes[3] = event.down ? 1 : 0;
+    put_u16(bytes + 4, event.key);
+    put_u16(bytes + 6, event.vk);
+    put_u16(bytes + 8, event.scancode);
+    put_f32(bytes + 12, event.x);
+    put_f32(bytes + 16, event.y);
+    ok = ok && fwrite(bytes, sizeof(bytes), 1, file_) == 1;
+  }
+
+  if (!ok) {
+    logger::error("Failed to write input recording, stopping");
+    stop();
+    return;
+  }
+  frame_++;
+}
+
+bool InputRecorder::next_frame(std::vector<InputEvent> &events, Frame &frame) {
+  events.clear();
+  if (mode_ != Mode::Replaying)
+    return false;
+  if (offset_ >= data_.size()) {
+    logger::info("Input replay finished after %u frames", frame_);
+    stop();
+    return false;
+  }
+
+  // start_replay trimmed data_ to complete frames, checked again so a frame never reads past it
+  const uint8_t *p = data_.data() + offset_;
+  size_t left = data_.size() - offset_;
+  if (left < FRAME_SIZE || get_u32(p + 16) > (left - FRAME_SIZE) / EVENT_SIZE) {
+    logger::error("Input recording is truncated at frame %u, stopping", frame_);
+    stop();
+    return false;
+  }
+
+  // Frames are numbered from 0 without gaps, anything else is a damaged or spliced file
+  frame.number = get_u32(p);
+  if (frame.number != frame_) {
+    logger::error("Input recording has frame %u where %u was expected, stopping", frame.number, frame_);
+    stop();
+    return false;
+  }
+  frame.delta_time = get_f32(p + 4);
+  frame.width = get_f32(p + 8);
+  frame.height = get_f32(p + 12);
+  uint32_t count = get_u32(p + 16);
+  p += FRAME_SIZE;
+
+  for (uint32_t i = 0; i < count; ++i, p += EVENT_SIZE) {
+    InputEvent event = {};
+    event.type = static_cast<InputEvent::Type>(p[0]);
+    event.source = p[1];
+    event.mods = p[2];
+    event.down = p[3] != 0;
+    event.key = get_u16(p + 4);
+    event.vk = get_u16(p + 6);
+    event.scancode = get_u16(p + 8);
+    event.x = get_f32(p + 12);
+    event.y = get_f32(p + 16);
+    events.push_back(event);
+  }
+
+  offset_ = static_cast<size_t>(p - data_.data());
+  frame_++;
+  return true;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "input_event.hpp"
+
+// Records the input events fed to ImGui each frame, with the frame's delta time and
+// display size, and plays them back in place of live input. Replays pin the delta time
+// and display size too, so a recorded UI session runs the same way every time.
+//
+// File: "LJEINPT2", then per frame a header (frame, delta time, width, height, event
+// count, all 32-bit) followed by its events (type, mouse source, modifiers and down as
+// bytes, key, virtual key, scancode and padding as 16-bit, x and y as floats), all
+// little-endian. Lua thread only.
+class InputRecorder {
+public:
+  enum class Mode { Idle, Recording, Replaying };
+
+  struct Frame {
+    uint32_t number = 0;
+    float delta_time = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+  };
+
+  InputRecorder() = default;
+  ~InputRecorder();
+
+  InputRecorder(const InputRecorder &) = delete;
+  InputRecorder &operator=(const InputRecorder &) = delete;
+
+  bool start_recording(const std::string &path);
+  // Loads the whole file up front, so replays don't touch the disk
+  bool start_replay(const std::string &path);
+  void stop();
+
+  Mode mode() const { return mode_; }
+  uint32_t frame() const { return frame_; }
+  uint32_t frame_count() const { return frame_count_; }
+
+  void record(const std::vector<InputEvent> &events, float delta_time, float width, float height);
+
+  // Replaces events with the next recorded frame's. Stops and returns false at the end of
+  // the recording, or at a frame out of sequence.
+  bool next_frame(std::vector<InputEvent> &events, Frame &frame);
+
+private:
+  Mode mode_ = Mode::Idle;
+  FILE *file_ = nullptr;
+  std::vector<uint8_t> data_; // Replay contents
+  size_t offset_ = 0;
+  uint32_t frame_ = 0;
+  uint32_t frame_count_ = 0; // Frames in the replay
+};
@@ -0,0 +1,215 @@
+#include "log.hpp"
+#include <Windows.h>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+namespace logger {
+
+namespace {
+
+constexpr size_t CAPACITY = 1024;
+constexpr size_t MASK = CAPACITY - 1;
+static_assert((CAPACITY & MASK) == 0, "capacity must be a power of two");
+
+// Writes happen at least this often, errors and bursts that fill a quarter of the ring wake
+// the writer at once
+constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(10);
+constexpr size_t WAKE_EVERY = CAPACITY / 4;
+
+// A slot's sequence is 2 * lap while free and 2 * lap + 1 once published for that lap, so
+// the zero-initialized ring is ready before any constructor runs
+detail::Slot ring[CAPACITY];
+std::atomic<size_t> enqueue_pos = 0;
+size_t dequeue_pos = 0; // Guarded by writer_mutex
+std::atomic<size_t> dropped = 0;
+
+enum class State { Idle, Running, Stopped };
+std::atomic<State> state = State::Idle;
+
+std::mutex writer_mutex;
+std::condition_variable writer_cv;
+
+// Without a logger::shutdown() the writer can't be joined at static destruction, the loader
+// lock may be held then
+struct Writer {
+  std::thread thread;
+  ~Writer() {
+    if (thread.joinable())
+      thread.detach();
+  }
+} writer;
+
+std::atomic<bool> wake = false;
+bool stop = false;
+FILE* file = nullptr;
+
+const char* level_prefix(Level level) {
+  switch (level) {
+  case Level::Debug: return "DEBUG: ";
+  case Level::Warn: return "WARN: ";
+  case Level::Error: return "ERROR: ";
+  default: return "";
+  }
+}
+
+void output(const char* data, size_t size) {
+  fwrite(data, 1, size, stdout);
+  fflush(stdout);
+  if (file) {
+    fwrite(data, 1, size, file);
+    fflush(file);
+  }
+}
+
+// Writes every published message in order, writer_mutex held
+void drain() {
+  char batch[16 * 1024];
+  size_t used = 0;
+
+  size_t lost = dropped.exchange(0, std::memory_order_relaxed);
+  if (lost > 0)
+    used += snprintf(batch, sizeof(batch), "[lje-imgui] WARN: %zu log messages dropped\n", lost);
+
+  for (;;) {
+    detail::Slot& slot = ring[dequeue_pos & MASK];
+    size_t lap = dequeue_pos / CAPACITY;
+    if (slot.sequence.load(std::memory_order_acquire) != 2 * lap + 1)
+      break;
+
+    auto seconds = static_cast<time_t>(slot.time_us / 1000000);
+    int ms = static_cast<int>((slot.time_us / 1000) % 1000);
+    tm local = {};
+    localtime_s(&local, &seconds);
+
+    char line[MAX_MESSAGE + 64];
+    int len = snprintf(line, sizeof(line), "[lje-imgui] %02d:%02d:%02d.%03d %5u %s%s\n", local.tm_hour, local.tm_min,
+                       local.tm_sec, ms, slot.thread, level_prefix(slot.level), slot.text);
+    if (len >= static_cast<int>(sizeof(line)))
+      len = static_cast<int>(sizeof(line)) - 1;
+
+    slot.sequence.store(2 * lap + 2, std::memory_order_release);
+    ++dequeue_pos;
+
+    if (used + static_cast<size_t>(len) > sizeof(batch)) {
+      output(batch, used);
+      used = 0;
+    }
+    memcpy(batch + used, line, len);
+    used += len;
+  }
+
+  if (used > 0)
+    output(batch, used);
+}
+
+void writer_func() {
+  std::unique_lock lock(writer_mutex);
+  while (!stop) {
+    writer_cv.wait_for(lock, FLUSH_INTERVAL, [] { return stop || wake.load(std::memory_order_relaxed); });
+    wake.store(false, std::memory_order_relaxed);
+    drain();
+  }
+  drain();
+}
+
+void start() {
+  std::lock_guard lock(writer_mutex);
+  if (state.load() != State::Idle)
+    return;
+  writer.thread = std::thread(writer_func);
+  state.store(State::Running);
+}
+
+} // namespace
+
+std::atomic<int> detail::min_level = static_cast<int>(Level::Info);
+
+detail::Slot* detail::claim() {
+  size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+  for (;;) {
+    Slot& slot = ring[pos & MASK];
+    size_t lap = pos / CAPACITY;
+    auto diff = static_cast<intptr_t>(slot.sequence.load(std::memory_order_acquire) - 2 * lap);
+    if (diff == 0) {
+      if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        return &slot;
+    } else if (diff < 0) {
+      // The writer hasn't freed this slot from the previous lap yet
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    } else {
+      pos = enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void detail::publish(Slot* slot, Level level) {
+  slot->level = level;
+  slot->thread = GetCurrentThreadId();
+  slot->time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::system_clock::now().time_since_epoch())
+                    .count();
+  slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+  State current = state.load(std::memory_order_acquire);
+  if (current == State::Running) {
+    if (level == Level::Error || (slot - ring) % WAKE_EVERY == WAKE_EVERY - 1) {
+      wake.store(true, std::memory_order_relaxed);
+      writer_cv.notify_one();
+    }
+  } else if (current == State::Idle) {
+    start();
+  } else {
+    std::lock_guard lock(writer_mutex);
+    drain();
+  }
+}
+
+void set_level(Level level) {
+  detail::min_level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+Level get_level() {
+  return static_cast<Level>(detail::min_level.load(std::memory_order_relaxed));
+}
+
+bool set_file(const char* path) {
+  std::lock_guard lock(writer_mutex);
+  if (file) {
+    fclose(file);
+    file = nullptr;
+  }
+  if (!path || !*path)
+    return true;
+
+  file = fopen(path, "a");
+  return file != nullptr;
+}
+
+void shutdown() {
+  {
+    std::lock_guard lock(writer_mutex);
+    if (state.load() != State::Running) {
+      state.store(State::Stopped);
+      drain();
+      return;
+    }
+    stop = true;
+  }
+  writer_cv.notify_one();
+  writer.thread.join();
+
+  std::lock_guard lock(writer_mutex);
+  state.store(State::Stopped);
+  drain();
+  if (file) {
+    fclose(file);
+    file = nullptr;
+  }
+}
+
+} // namespace logger
@@ -1,27 +1,83 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
 
+// Lowest level compiled in, calls below it are removed entirely (0 debug, 1 info, 2 warn, 3 error)
+#ifndef LJE_IMGUI_LOG_LEVEL
+#define LJE_IMGUI_LOG_LEVEL 0
+#endif
+
+// Log calls format into a slot of a lock-free ring buffer and return, a background thread
+// writes the messages out with their timestamp and thread ID. Messages logged while the ring
+// is full are dropped and counted.
 namespace logger {
 
+enum class Level : uint8_t { Debug, Info, Warn, Error };
+
+// Longer messages are truncated
+constexpr size_t MAX_MESSAGE = 224;
+
+// Runtime filter on top of LJE_IMGUI_LOG_LEVEL, Info by default
+void set_level(Level level);
+Level get_level();
+
+// Also appends messages to a file, nullptr closes it. Returns false if it can't be opened
+bool set_file(const char* path);
+
+// Writes out queued messages and stops the writer thread, later messages are written directly
+void shutdown();
+
+namespace detail {
+
+struct alignas(64) Slot {
+  std::atomic<size_t> sequence;
+  Level level;
+  uint32_t thread;
+  int64_t time_us;
+  char text[MAX_MESSAGE];
+};
+
+extern std::atomic<int> min_level;
+
+// Returns nullptr when the ring is full
+Slot* claim();
+void publish(Slot* slot, Level level);
+
+template<Level L, typename... Args>
+inline void write(const char* fmt, Args... args) {
+  if constexpr (static_cast<int>(L) >= LJE_IMGUI_LOG_LEVEL) {
+    if (static_cast<int>(L) < min_level.load(std::memory_order_relaxed))
+      return;
+    Slot* slot = claim();
+    if (!slot)
+      return;
+    snprintf(slot->text, MAX_MESSAGE, fmt, args...);
+    publish(slot, L);
+  }
+}
+
+} // namespace detail
+
+template<typename... Args>
+inline void debug(const char* fmt, Args... args) {
+  detail::write<Level::Debug>(fmt, args...);
+}
+
 template<typename... Args>
 inline void info(const char* fmt, Args... args) {
-  printf("[lje-imgui] ");
-  printf(fmt, args...);
-  printf("\n");
+  detail::write<Level::Info>(fmt, args...);
 }
 
 template<typename... Args>
 inline void warn(const char* fmt, Args... args) {
-  printf("[lje-imgui] WARN: ");
-  printf(fmt, args...);
-  printf("\n");
+  detail::write<Level::Warn>(fmt, args...);
 }
 
 template<typename... Args>
 inline void error(const char* fmt, Args... args) {
-  printf("[lje-imgui] ERROR: ");
-  printf(fmt, args...);
-  printf("\n");
+  detail::write<Level::Error>(fmt, args...);
 }
 
 } // namespace logger
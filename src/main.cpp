@@ -31,5 +31,6 @@ LJE_MODULE_PREINIT() {
 LJE_MODULE_SHUTDOWN() {
   logger::info("Shutting down lje-imgui...");
   Overlay::destroy();
+  logger::shutdown();
   return LJE_RESULT_OK;
 }
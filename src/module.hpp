@@ -1,8 +1,8 @@
 #pragma once
 #include <Windows.h>
 #include <cstdint>
-#include <string>
 #include <vector>
+#include "scan.hpp"
 
 class Module {
 public:
@@ -11,6 +11,19 @@ public:
     auto dos = reinterpret_cast<IMAGE_DOS_HEADER*>(base_);
     auto nt = reinterpret_cast<IMAGE_NT_HEADERS*>(base_ + dos->e_lfanew);
     size_ = nt->OptionalHeader.SizeOfImage;
+    timestamp_ = nt->FileHeader.TimeDateStamp;
+
+    // First executable section, where signatures live
+    auto section = IMAGE_FIRST_SECTION(nt);
+    for (WORD i = 0; i < nt->FileHeader.NumberOfSections; ++i, ++section) {
+      if (section->Characteristics & IMAGE_SCN_CNT_CODE) {
+        code_base_ = base_ + section->VirtualAddress;
+        code_size_ = section->Misc.VirtualSize;
+        code_file_offset_ = section->PointerToRawData;
+        code_file_size_ = section->SizeOfRawData;
+        break;
+      }
+    }
   }
 
   Module(const char* name)
@@ -18,45 +31,64 @@ public:
 
   uintptr_t base() const { return base_; }
   size_t size() const { return size_; }
+  HMODULE handle() const { return reinterpret_cast<HMODULE>(base_); }
+
+  // PE link timestamp, changes with every build of the module
+  uint32_t timestamp() const { return timestamp_; }
+  uintptr_t code_base() const { return code_base_; }
+  size_t code_size() const { return code_size_; }
+
+  // Where the code section is stored in the file, before relocations were applied
+  uint32_t code_file_offset() const { return code_file_offset_; }
+  uint32_t code_file_size() const { return code_file_size_; }
 
   uintptr_t scan(const char* pattern) const {
-    auto [bytes, mask] = parse(pattern);
-    auto data = reinterpret_cast<uint8_t*>(base_);
-
-    for (size_t i = 0; i < size_ - bytes.size(); ++i) {
-      bool found = true;
-      for (size_t j = 0; j < bytes.size(); ++j) {
-        if (mask[j] && data[i + j] != bytes[j]) {
-          found = false;
-          break;
-        }
+    return scan(scan::parse(pattern));
+  }
+
+  uintptr_t scan(const scan::Pattern& pattern) const {
+    auto found = scan::find(reinterpret_cast<const uint8_t*>(base_), size_, pattern);
+    return found ? reinterpret_cast<uintptr_t>(found) : 0;
+  }
+
+  // Compile-time pattern, e.g. module.scan("48 8B 05 ? ? ? ?"_sig)
+  template<size_t N>
+  uintptr_t scan(const scan::FixedPattern<N>& pattern) const {
+    auto found = scan::find(reinterpret_cast<const uint8_t*>(base_), size_, pattern);
+    return found ? reinterpret_cast<uintptr_t>(found) : 0;
+  }
+
+  // Every pattern resolved in one parallel pass over the image, see scan::find_many.
+  // Returns the addresses of the hits per pattern, in the order the patterns were given.
+  std::vector<std::vector<uintptr_t>> scan_many(const std::vector<scan::Pattern>& patterns,
+                                                scan::Hits hits = scan::Hits::All) const {
+    auto offsets = scan::find_many(reinterpret_cast<const uint8_t*>(base_), size_, patterns, hits);
+    std::vector<std::vector<uintptr_t>> addresses(offsets.size());
+    for (size_t i = 0; i < offsets.size(); ++i) {
+      addresses[i].reserve(offsets[i].size());
+      for (size_t offset : offsets[i]) {
+        addresses[i].push_back(base_ + offset);
       }
-      if (found) return base_ + i;
     }
-    return 0;
+    return addresses;
+  }
+
+  std::vector<std::vector<uintptr_t>> scan_many(const std::vector<const char*>& patterns,
+                                                scan::Hits hits = scan::Hits::All) const {
+    std::vector<scan::Pattern> parsed;
+    parsed.reserve(patterns.size());
+    for (const char* pattern : patterns) {
+      parsed.push_back(scan::parse(pattern));
+    }
+    return scan_many(parsed, hits);
   }
 
 private:
   uintptr_t base_;
   size_t size_;
-
-  static std::pair<std::vector<uint8_t>, std::vector<bool>> parse(const char* pattern) {
-    std::vector<uint8_t> bytes;
-    std::vector<bool> mask;
-
-    for (const char* p = pattern; *p; ++p) {
-      if (*p == ' ') continue;
-      if (*p == '?') {
-        bytes.push_back(0);
-        mask.push_back(false);
-        if (*(p + 1) == '?') ++p;
-      } else {
-        char byte[3] = { p[0], p[1], 0 };
-        bytes.push_back(static_cast<uint8_t>(strtoul(byte, nullptr, 16)));
-        mask.push_back(true);
-        ++p;
-      }
-    }
-    return { bytes, mask };
-  }
+  uint32_t timestamp_ = 0;
+  uintptr_t code_base_ = 0;
+  size_t code_size_ = 0;
+  uint32_t code_file_offset_ = 0;
+  uint32_t code_file_size_ = 0;
 };
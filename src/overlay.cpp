@@ -1,65 +1,88 @@
 #include "overlay.hpp"
 #include "log.hpp"
 #include "api/imnodes_api.hpp"
+#include "render/dx9_renderer.hpp"
+#include "render/null_renderer.hpp"
 #include <imgui.h>
-#include <imgui_impl_dx9.h>
 #include <imgui_impl_win32.h>
 #include <imnodes.h>
-
-extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND, UINT, WPARAM, LPARAM);
+#include <algorithm>
 
 namespace {
 constexpr size_t ENDSCENE_VTABLE_INDEX = 42;
 constexpr size_t RESET_VTABLE_INDEX = 16;
-}
 
-std::shared_ptr<Overlay> Overlay::instance_ = nullptr;
+// With a UI rate set, the last frame is drawn again until Lua has missed this many updates
+constexpr float STALE_FRAME_UPDATES = 4.0f;
 
-std::shared_ptr<Overlay> Overlay::get() {
-  return instance_;
-}
-
-void Overlay::create() {
-  logger::info("Overlay::create()");
-  instance_ = std::shared_ptr<Overlay>(new Overlay());
-}
+// Init retries start fast and back off while the game has not created its device yet
+constexpr auto INIT_BACKOFF_MIN = std::chrono::milliseconds(10);
+constexpr auto INIT_BACKOFF_MAX = std::chrono::milliseconds(1000);
 
-void Overlay::destroy() {
-  logger::info("Overlay::destroy()");
-  if (instance_) {
-    instance_->shutdown();
-    instance_.reset();
-  }
-}
-
-void Overlay::init_async() {
-  logger::info("Overlay::init_async() - spawning init thread");
-  state_ = State::Waiting;
-  init_thread_ = std::thread(&Overlay::init_thread_func, this);
+std::chrono::nanoseconds ui_interval(float hz) {
+  return std::chrono::nanoseconds(static_cast<int64_t>(1e9 / hz));
 }
 
-void Overlay::init_thread_func() {
-  logger::info("Overlay::init_thread_func() - started");
-
-  while (state_ == State::Waiting) {
-    if (try_init()) {
-      logger::info("Overlay::init_thread_func() - init succeeded");
-      return;
+void add_input_event(ImGuiIO &io, const InputEvent &event) {
+  switch (event.type) {
+  case InputEvent::Type::MousePos:
+    io.AddMouseSourceEvent(static_cast<ImGuiMouseSource>(event.source));
+    io.AddMousePosEvent(event.x, event.y);
+    break;
+  case InputEvent::Type::MouseButton:
+    io.AddMouseSourceEvent(static_cast<ImGuiMouseSource>(event.source));
+    io.AddMouseButtonEvent(event.key, event.down);
+    break;
+  case InputEvent::Type::MouseWheel:
+    io.AddMouseWheelEvent(event.x, event.y);
+    break;
+  case InputEvent::Type::Key: {
+    // Modifiers as they were when the window thread saw the key
+    io.AddKeyEvent(ImGuiMod_Ctrl, (event.mods & InputEvent::MOD_CTRL) != 0);
+    io.AddKeyEvent(ImGuiMod_Shift, (event.mods & InputEvent::MOD_SHIFT) != 0);
+    io.AddKeyEvent(ImGuiMod_Alt, (event.mods & InputEvent::MOD_ALT) != 0);
+    io.AddKeyEvent(ImGuiMod_Super, (event.mods & InputEvent::MOD_SUPER) != 0);
+    auto key = static_cast<ImGuiKey>(event.key);
+    if (key != ImGuiKey_None) {
+      io.AddKeyEvent(key, event.down);
+      io.SetKeyEventNativeData(key, event.vk, event.scancode);
     }
-    Sleep(100);
+    break;
+  }
+  case InputEvent::Type::Char:
+    io.AddInputCharacterUTF16(event.key);
+    break;
+  case InputEvent::Type::Focus:
+    io.AddFocusEvent(event.down);
+    break;
   }
-
-  logger::info("Overlay::init_thread_func() - aborted");
 }
 
-bool Overlay::try_init() {
-  logger::info("Overlay::try_init() - attempt");
-
-  if (!hook::init()) {
-    logger::error("Failed to initialize MinHook");
-    return false;
+LPCTSTR cursor_resource(int cursor) {
+  switch (cursor) {
+  case ImGuiMouseCursor_TextInput: return IDC_IBEAM;
+  case ImGuiMouseCursor_ResizeAll: return IDC_SIZEALL;
+  case ImGuiMouseCursor_ResizeNS: return IDC_SIZENS;
+  case ImGuiMouseCursor_ResizeEW: return IDC_SIZEWE;
+  case ImGuiMouseCursor_ResizeNESW: return IDC_SIZENESW;
+  case ImGuiMouseCursor_ResizeNWSE: return IDC_SIZENWSE;
+  case ImGuiMouseCursor_Hand: return IDC_HAND;
+  case ImGuiMouseCursor_NotAllowed: return IDC_NO;
+  default: return IDC_ARROW;
   }
+}
 
+// EndScene/Reset addresses stay valid as long as d3d9.dll stays loaded at the same base,
+// so a re-init does not need another dummy device
+struct VtableSlots {
+  HMODULE module = nullptr;
+  uintptr_t endscene = 0;
+  uintptr_t reset = 0;
+};
+VtableSlots cached_slots;
+
+// Reads the device vtable from a throwaway device on a hidden window
+bool resolve_vtable_slots(VtableSlots &slots) {
   // Create temp window for dummy device
   WNDCLASSEXA wc = {};
   wc.cbSize = sizeof(wc);
@@ -75,7 +98,6 @@ bool Overlay::try_init() {
 
   if (!temp_hwnd) {
     UnregisterClassA(wc.lpszClassName, wc.hInstance);
-    hook::shutdown();
     return false;
   }
 
@@ -83,7 +105,6 @@ bool Overlay::try_init() {
   if (!d3d) {
     DestroyWindow(temp_hwnd);
     UnregisterClassA(wc.lpszClassName, wc.hInstance);
-    hook::shutdown();
     return false;
   }
 
@@ -103,21 +124,103 @@ bool Overlay::try_init() {
     d3d->Release();
     DestroyWindow(temp_hwnd);
     UnregisterClassA(wc.lpszClassName, wc.hInstance);
-    hook::shutdown();
     return false;
   }
 
   logger::info("Overlay::try_init() - dummy device created");
 
   auto vtable = *reinterpret_cast<uintptr_t **>(dummy);
-  auto endscene_addr = vtable[ENDSCENE_VTABLE_INDEX];
-  auto reset_addr = vtable[RESET_VTABLE_INDEX];
-  logger::info("Overlay::try_init() - endscene=%p reset=%p", endscene_addr, reset_addr);
+  slots.endscene = vtable[ENDSCENE_VTABLE_INDEX];
+  slots.reset = vtable[RESET_VTABLE_INDEX];
 
   dummy->Release();
   d3d->Release();
   DestroyWindow(temp_hwnd);
   UnregisterClassA(wc.lpszClassName, wc.hInstance);
+  return true;
+}
+}
+
+std::shared_ptr<Overlay> Overlay::instance_ = nullptr;
+
+std::shared_ptr<Overlay> Overlay::get() {
+  return instance_;
+}
+
+void Overlay::create() {
+  logger::info("Overlay::create()");
+  instance_ = std::shared_ptr<Overlay>(new Overlay());
+}
+
+void Overlay::destroy() {
+  logger::info("Overlay::destroy()");
+  if (instance_) {
+    instance_->shutdown();
+    instance_.reset();
+  }
+}
+
+void Overlay::init_async() {
+  logger::info("Overlay::init_async() - spawning init thread");
+  state_ = State::Waiting;
+  init_thread_ = std::thread(&Overlay::init_thread_func, this);
+}
+
+void Overlay::init_thread_func() {
+  logger::info("Overlay::init_thread_func() - started");
+
+  auto start = std::chrono::steady_clock::now();
+  auto backoff = std::chrono::duration_cast<std::chrono::milliseconds>(INIT_BACKOFF_MIN);
+  int attempts = 0;
+
+  std::unique_lock lock(init_mutex_);
+  while (state_ == State::Waiting) {
+    lock.unlock();
+    attempts++;
+    bool ready = try_init();
+    lock.lock();
+
+    if (ready) {
+      auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+      logger::info("Overlay::init_thread_func() - init succeeded after %.1f ms (%d attempts)", elapsed.count(),
+                   attempts);
+      return;
+    }
+
+    // Woken right away by shutdown()
+    init_cv_.wait_for(lock, backoff, [this] { return state_ != State::Waiting; });
+    backoff = (std::min)(backoff * 2, std::chrono::duration_cast<std::chrono::milliseconds>(INIT_BACKOFF_MAX));
+  }
+
+  logger::info("Overlay::init_thread_func() - aborted");
+}
+
+bool Overlay::try_init() {
+  // Nothing to hook until the game has loaded D3D9
+  HMODULE d3d9 = GetModuleHandleA("d3d9.dll");
+  if (!d3d9)
+    return false;
+
+  logger::info("Overlay::try_init() - attempt");
+
+  VtableSlots slots = cached_slots;
+  if (slots.module != d3d9) {
+    if (!resolve_vtable_slots(slots))
+      return false;
+    slots.module = d3d9;
+    cached_slots = slots;
+  } else {
+    logger::info("Overlay::try_init() - using cached vtable slots");
+  }
+
+  auto endscene_addr = slots.endscene;
+  auto reset_addr = slots.reset;
+  logger::info("Overlay::try_init() - endscene=%p reset=%p", endscene_addr, reset_addr);
+
+  if (!hook::init()) {
+    logger::error("Failed to initialize MinHook");
+    return false;
+  }
 
   // EndScene hook - capture device pointer and render ImGui
   if (!endscene_.create(endscene_addr, [](IDirect3DDevice9 *dev) -> HRESULT {
@@ -129,6 +232,8 @@ bool Overlay::try_init() {
       overlay->init_imgui(dev);
     }
 
+    Profiler::Scope scope(overlay->profiler_, Profiler::Phase::EndScene);
+
     // Render ImGui draw data
     overlay->render_draw_data();
 
@@ -158,7 +263,17 @@ bool Overlay::try_init() {
   endscene_.enable();
   reset_.enable();
 
-  state_ = State::Ready;
+  // shutdown() may have run meanwhile, it only tears hooks down once it has seen Ready
+  auto expected = State::Waiting;
+  if (!state_.compare_exchange_strong(expected, State::Ready)) {
+    endscene_.disable();
+    endscene_.remove();
+    reset_.disable();
+    reset_.remove();
+    hook::shutdown();
+    return false;
+  }
+
   logger::info("Overlay::try_init() - ready");
   return true;
 }
@@ -170,6 +285,11 @@ void Overlay::shutdown() {
   if (prev_state == State::Shutdown)
     return;
 
+  {
+    std::lock_guard lock(init_mutex_);
+  }
+  init_cv_.notify_all();
+
   if (init_thread_.joinable()) {
     logger::info("Overlay::shutdown() - joining init thread");
     init_thread_.join();
@@ -199,10 +319,167 @@ void Overlay::new_frame() {
   if (frame_started_)
     return; // Already in a frame
 
-  ImGui_ImplDX9_NewFrame();
-  ImGui_ImplWin32_NewFrame();
+  // Fonts read in the background join the atlas between frames
+  fonts_.commit();
+
+  if (!pipeline_enabled()) {
+    // Hidden, nothing is drawn. Input queued before hiding is stale by the time it's shown.
+    input_.discard();
+    capture_flags_ = 0;
+
+    // Widgets called while hidden still need a frame to land in, it is ended without rendering
+    ImGui::NewFrame();
+    frame_started_ = true;
+    hidden_frame_ = true;
+    return;
+  }
+  hidden_frame_ = false;
+
+  Profiler::Scope scope(profiler_, Profiler::Phase::NewFrame);
+
+  renderer_->new_frame();
+  platform_new_frame();
+  feed_input();
   ImGui::NewFrame();
   frame_started_ = true;
+  textures_.new_frame();
+  id_cache_.new_frame();
+
+  ImGuiIO &io = ImGui::GetIO();
+  capture_flags_.store((io.WantCaptureMouse ? CAPTURE_MOUSE : 0) | (io.WantCaptureKeyboard ? CAPTURE_KEYBOARD : 0),
+                       std::memory_order_release);
+
+  float rate = current_ui_rate();
+  active_rate_ = rate;
+  throttled_ = rate > 0.0f && rate != ui_rate_;
+  if (rate > 0.0f) {
+    // Keep a steady cadence when updates arrive on time, restart it after early or late ones
+    auto now = Clock::now();
+    auto interval = ui_interval(rate);
+    if (now >= next_update_ && now - next_update_ < interval)
+      next_update_ += interval;
+    else
+      next_update_ = now + interval;
+  }
+
+  if (profiler_.enabled())
+    build_start_ = Profiler::Clock::now();
+}
+
+// What ImGui_ImplWin32_NewFrame does minus reading input: its key workarounds call
+// GetKeyState, which sees this thread's input state rather than the window's. The cursor
+// shape is handed to wndproc, which sets it on WM_SETCURSOR.
+void Overlay::platform_new_frame() {
+  ImGuiIO &io = ImGui::GetIO();
+
+  RECT rect = {};
+  GetClientRect(hwnd_, &rect);
+  io.DisplaySize = ImVec2(static_cast<float>(rect.right - rect.left), static_cast<float>(rect.bottom - rect.top));
+
+  auto now = Clock::now();
+  if (last_frame_time_ != Clock::time_point())
+    io.DeltaTime = (std::max)(std::chrono::duration<float>(now - last_frame_time_).count(), 1e-6f);
+  last_frame_time_ = now;
+
+  // A replay owns the mouse, the real cursor is left alone
+  bool replaying = recorder_.mode() == InputRecorder::Mode::Replaying;
+  if (io.WantSetMousePos && !replaying && GetForegroundWindow() == hwnd_) {
+    POINT pos = {static_cast<LONG>(io.MousePos.x), static_cast<LONG>(io.MousePos.y)};
+    if (ClientToScreen(hwnd_, &pos))
+      SetCursorPos(pos.x, pos.y);
+  }
+
+  mouse_cursor_.store(io.MouseDrawCursor ? ImGuiMouseCursor_None : ImGui::GetMouseCursor(), std::memory_order_relaxed);
+}
+
+void Overlay::feed_input() {
+  ImGuiIO &io = ImGui::GetIO();
+  input_batch_.clear();
+  input_.drain(input_batch_);
+
+  if (recorder_.mode() == InputRecorder::Mode::Recording) {
+    recorder_.record(input_batch_, io.DeltaTime, io.DisplaySize.x, io.DisplaySize.y);
+  } else if (recorder_.mode() == InputRecorder::Mode::Replaying) {
+    // Live input is dropped, the recorded frame also pins timing and display size
+    InputRecorder::Frame frame;
+    if (recorder_.next_frame(input_batch_, frame)) {
+      io.DeltaTime = frame.delta_time > 0.0f ? frame.delta_time : io.DeltaTime;
+      io.DisplaySize = ImVec2(frame.width, frame.height);
+    }
+  }
+
+  // Keys and buttons held live when a replay starts, or by the replay when it ends, are let go
+  bool replaying = recorder_.mode() == InputRecorder::Mode::Replaying;
+  if (replaying != replaying_) {
+    io.ClearInputKeys();
+    io.ClearInputMouse();
+    replaying_ = replaying;
+  }
+
+  for (const auto &event : input_batch_) {
+    add_input_event(io, event);
+  }
+
+  // A lost key or button release would leave it held, start over from a clean state
+  if (input_.take_dropped() > 0) {
+    io.ClearInputKeys();
+    io.ClearInputMouse();
+  }
+}
+
+bool Overlay::should_update() const {
+  if (!pipeline_enabled())
+    return false;
+
+  // Input wakes an idle UI right away
+  if (throttled_ && input_events_ != seen_input_events_)
+    return true;
+
+  float rate = current_ui_rate();
+  if (rate <= 0.0f)
+    return true;
+  return Clock::now() >= next_update_;
+}
+
+float Overlay::current_ui_rate() const {
+  float rate = ui_rate_;
+  if (is_idle() && (rate <= 0.0f || idle_rate_ < rate))
+    return idle_rate_;
+  return rate;
+}
+
+void Overlay::set_hud_windows(std::vector<std::string> names) {
+  hud_windows_.clear();
+  for (auto &name : names) {
+    hud_windows_.insert(std::move(name));
+  }
+  has_hud_windows_ = !hud_windows_.empty();
+}
+
+bool Overlay::is_window_shown(const char *name) const {
+  if (visible_)
+    return true;
+  return name && hud_windows_.count(name) > 0;
+}
+
+void Overlay::set_idle_policy(int frames, float idle_hz) {
+  idle_after_frames_ = frames > 0 && idle_hz > 0.0f ? frames : 0;
+  idle_rate_ = idle_hz > 0.0f ? (std::max)(idle_hz, MIN_UI_RATE) : 0.0f;
+  quiet_frames_ = 0;
+}
+
+bool Overlay::is_idle() const {
+  return idle_after_frames_ > 0 && quiet_frames_ >= idle_after_frames_ &&
+         input_events_ == seen_input_events_;
+}
+
+void Overlay::update_idle(bool content_changed) {
+  uint32_t events = input_events_;
+  if (content_changed || events != seen_input_events_)
+    quiet_frames_ = 0;
+  else if (quiet_frames_ < idle_after_frames_)
+    quiet_frames_++;
+  seen_input_events_ = events;
 }
 
 void Overlay::render() {
@@ -211,50 +488,100 @@ void Overlay::render() {
 
   frame_started_ = false;
 
+  if (hidden_frame_) {
+    ImGui::EndFrame();
+    return;
+  }
+
+  if (profiler_.enabled() && build_start_ != Profiler::Clock::time_point())
+    profiler_.record(Profiler::Phase::Build, build_start_, Profiler::Clock::now());
+
+  Profiler::Scope scope(profiler_, Profiler::Phase::Render);
+
+  if (profiler_.window_shown())
+    profiler_.draw_window();
+
   // Finalize draw data - actual D3D9 rendering happens in EndScene
   ImGui::EndFrame();
   ImGui::Render();
-  frame_ready_ = true;
+
+  // Texture work is copied out here, the render thread never reads the live textures
+  ImDrawData *draw_data = ImGui::GetDrawData();
+  texture_sync_.collect(draw_data->Textures);
+
+  bool changed = false;
+  auto &slot = snapshots_.write_slot();
+  bool has_requests = texture_sync_.has_requests() || !slot.requests_applied();
+  if (window_cache_.capture(draw_data, slot, has_requests)) {
+    if (optimize_draws_)
+      draw_optimizer_.run(slot);
+    texture_sync_.publish(slot);
+    if (idle_after_frames_ > 0) {
+      uint64_t hash = slot.hash();
+      changed = hash != last_frame_hash_ || has_requests;
+      last_frame_hash_ = hash;
+    }
+    snapshots_.publish();
+  } else {
+    replay_requested_ = true;
+  }
+  last_publish_ticks_ = Clock::now().time_since_epoch().count();
+
+  if (idle_after_frames_ > 0)
+    update_idle(changed);
 }
 
 void Overlay::render_draw_data() {
-  if (!frame_ready_ || !device_)
+  if (!imgui_initialized_ || !pipeline_enabled())
     return;
 
-  frame_ready_ = false;
+  Profiler::Scope scope(profiler_, Profiler::Phase::RenderDrawData);
 
-  auto draw_data = ImGui::GetDrawData();
-  if (!draw_data)
-    return;
+  bool replay = replay_requested_.exchange(false);
+  bool fresh = snapshots_.acquire();
 
-  // Save sRGB state
-  DWORD srgb_write, srgb_texture;
-  device_->GetRenderState(D3DRS_SRGBWRITEENABLE, &srgb_write);
-  device_->GetSamplerState(0, D3DSAMP_SRGBTEXTURE, &srgb_texture);
+  // Textures first, the new frame's commands may already use them
+  auto &slot = snapshots_.read_slot();
+  if (fresh && !slot.requests_applied()) {
+    renderer_->update_textures(slot.texture_requests());
+    texture_sync_.complete(slot.texture_requests());
+    slot.set_requests_applied(true);
+  }
 
-  // Disable sRGB for ImGui
-  device_->SetRenderState(D3DRS_SRGBWRITEENABLE, FALSE);
-  device_->SetSamplerState(0, D3DSAMP_SRGBTEXTURE, FALSE);
+  if (!fresh && !replay) {
+    // Between UI updates keep drawing the last completed frame, as long as Lua is still
+    // producing frames at roughly the configured rate
+    float rate = active_rate_;
+    if (rate <= 0.0f)
+      return;
+
+    auto last_publish = Clock::time_point(Clock::duration(last_publish_ticks_.load()));
+    auto stale_after = std::chrono::duration_cast<Clock::duration>(ui_interval(rate) * STALE_FRAME_UPDATES);
+    if (Clock::now() - last_publish > stale_after)
+      return;
+  }
 
-  ImGui_ImplDX9_RenderDrawData(draw_data);
+  auto draw_data = slot.data();
+  if (!draw_data->Valid)
+    return;
 
-  // Restore sRGB state
-  device_->SetRenderState(D3DRS_SRGBWRITEENABLE, srgb_write);
-  device_->SetSamplerState(0, D3DSAMP_SRGBTEXTURE, srgb_texture);
+  renderer_->render(draw_data);
 }
 
 void Overlay::on_reset() {
   logger::info("Overlay::on_reset()");
   frame_started_ = false;
   if (imgui_initialized_) {
-    ImGui_ImplDX9_InvalidateDeviceObjects();
+    std::vector<ImTextureData *> lost;
+    renderer_->invalidate_device_objects(lost);
+    texture_sync_.lost(lost);
   }
 }
 
 void Overlay::on_reset_after(IDirect3DDevice9 *dev) {
   logger::info("Overlay::on_reset_after()");
   if (imgui_initialized_) {
-    ImGui_ImplDX9_CreateDeviceObjects();
+    renderer_->create_device_objects();
   }
 }
 
@@ -282,8 +609,15 @@ bool Overlay::init_imgui(IDirect3DDevice9 *dev) {
     return false;
   }
 
-  if (!ImGui_ImplDX9_Init(dev)) {
-    logger::error("Failed to init ImGui DX9");
+#ifdef LJE_IMGUI_NULL_RENDERER
+  // Headless build, frames are built, captured and counted but never reach the device
+  renderer_ = std::make_unique<NullRenderer>();
+#else
+  renderer_ = std::make_unique<Dx9Renderer>(dev);
+#endif
+  if (!renderer_->init()) {
+    logger::error("Failed to init ImGui renderer (%s)", renderer_->name());
+    renderer_.reset();
     return false;
   }
 
@@ -306,10 +640,18 @@ void Overlay::shutdown_imgui() {
     SetWindowLongPtr(hwnd_, GWLP_WNDPROC, reinterpret_cast<LONG_PTR>(original_wndproc_));
   }
 
-  ImGui_ImplDX9_Shutdown();
+  renderer_->shutdown();
+  renderer_.reset();
+  texture_sync_.release();
   ImGui_ImplWin32_Shutdown();
+  snapshots_.release();
+  window_cache_.release();
+  draw_optimizer_.release();
+  textures_.release();
+  id_cache_.clear();
   imnodes_api::shutdown();
   ImGui::DestroyContext();
+  fonts_.release();
 
   imgui_initialized_ = false;
   logger::info("Overlay::shutdown_imgui() - done");
@@ -329,14 +671,24 @@ LRESULT CALLBACK Overlay::wndproc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lpa
     return DefWindowProc(hwnd, msg, wparam, lparam);
   }
 
+  if ((msg >= WM_MOUSEFIRST && msg <= WM_MOUSELAST) || (msg >= WM_KEYFIRST && msg <= WM_KEYLAST)) {
+    overlay->input_events_.fetch_add(1, std::memory_order_relaxed);
+  }
+
   // Toggle visibility with INSERT key
   if (msg == WM_KEYDOWN && wparam == VK_INSERT) {
     overlay->toggle_visible();
   }
 
-  // When visible, let ImGui handle input first
+  // When visible, queue input for the next frame. The ImGui context belongs to the thread
+  // building frames, so it isn't touched here.
   if (overlay->is_visible()) {
-    if (ImGui_ImplWin32_WndProcHandler(hwnd, msg, wparam, lparam)) {
+    overlay->input_.push_message(hwnd, msg, wparam, lparam);
+
+    // Show the cursor ImGui asked for while it is over an ImGui window
+    if (msg == WM_SETCURSOR && LOWORD(lparam) == HTCLIENT && overlay->wants_mouse()) {
+      int cursor = overlay->mouse_cursor_.load(std::memory_order_relaxed);
+      SetCursor(cursor == ImGuiMouseCursor_None ? nullptr : LoadCursor(nullptr, cursor_resource(cursor)));
       return true;
     }
 
@@ -353,11 +705,13 @@ LRESULT CALLBACK Overlay::wndproc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lpa
     case WM_KEYDOWN:
     case WM_KEYUP:
     case WM_CHAR:
-      if (ImGui::GetIO().WantCaptureMouse || ImGui::GetIO().WantCaptureKeyboard) {
+      if (overlay->wants_mouse() || overlay->wants_keyboard()) {
         return true;
       }
       break;
     }
+  } else {
+    overlay->input_.reset_mouse(hwnd);
   }
 
   return CallWindowProc(overlay->original_wndproc_, hwnd, msg, wparam, lparam);
@@ -1,10 +1,28 @@
 #pragma once
 #include <Windows.h>
 #include <d3d9.h>
+#include <algorithm>
 #include <memory>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
 #include "hook.hpp"
+#include "draw_snapshot.hpp"
+#include "draw_optimizer.hpp"
+#include "window_cache.hpp"
+#include "profiler.hpp"
+#include "font_loader.hpp"
+#include "texture_sync.hpp"
+#include "user_textures.hpp"
+#include "input_queue.hpp"
+#include "input_recorder.hpp"
+#include "id_cache.hpp"
+#include "render/renderer.hpp"
 
 class Overlay {
 public:
@@ -26,11 +44,47 @@ public:
   void on_reset();
   void on_reset_after(IDirect3DDevice9 *dev);
 
+  // Capture decisions published by the last frame, safe to read from wndproc
+  bool wants_mouse() const { return capture_flags_.load(std::memory_order_acquire) & CAPTURE_MOUSE; }
+  bool wants_keyboard() const { return capture_flags_.load(std::memory_order_acquire) & CAPTURE_KEYBOARD; }
+
   bool is_visible() const { return visible_; }
   void set_visible(bool v) { visible_ = v; }
   void toggle_visible() { visible_ = !visible_; }
 
+  // While hidden nothing is rendered, new_frame only opens an empty ImGui frame so stray widget
+  // calls stay valid, unless some windows are marked to stay on screen (HUD panels); then
+  // only those windows are built and drawn.
+  void set_hud_windows(std::vector<std::string> names);
+  bool is_window_shown(const char *name) const;
+  bool in_frame() const { return frame_started_; }
+
+  // Drop to idle_hz after this many frames without input or content changes, 0 disables
+  void set_idle_policy(int frames, float idle_hz);
+  bool is_idle() const;
+
+  // UI tick rate in Hz, 0 updates every frame. Between updates EndScene keeps drawing the
+  // last completed frame, and Lua can skip building one when should_update() is false.
+  // Positive rates below MIN_UI_RATE are raised to it, so the update interval stays in range.
+  static constexpr float MIN_UI_RATE = 0.01f;
+  void set_ui_rate(float hz) { ui_rate_ = hz > 0.0f ? (std::max)(hz, MIN_UI_RATE) : 0.0f; }
+  float ui_rate() const { return ui_rate_; }
+  bool should_update() const;
+  float current_ui_rate() const;
+
   State state() const { return state_; }
+  Renderer *renderer() const { return renderer_.get(); }
+  WindowCache &window_cache() { return window_cache_; }
+  Profiler &profiler() { return profiler_; }
+  FontLoader &fonts() { return fonts_; }
+  UserTextures &textures() { return textures_; }
+  InputRecorder &input_recorder() { return recorder_; }
+  IdCache &id_cache() { return id_cache_; }
+
+  // Merge/cull pass over every captured frame, on by default. Stats are Lua thread only.
+  void set_draw_optimization(bool enabled) { optimize_draws_ = enabled; }
+  bool draw_optimization() const { return optimize_draws_; }
+  const DrawOptimizer::Stats &draw_stats() const { return draw_optimizer_.last_frame(); }
 
   Hook<EndScene_t> &endscene_hook() { return endscene_; }
   Hook<Reset_t> &reset_hook() { return reset_; }
@@ -42,6 +96,10 @@ private:
   bool try_init();
   bool init_imgui(IDirect3DDevice9 *dev);
   void shutdown_imgui();
+  bool pipeline_enabled() const { return visible_ || has_hud_windows_; }
+  void update_idle(bool content_changed);
+  void platform_new_frame();
+  void feed_input();
   HWND get_device_window(IDirect3DDevice9 *dev);
 
   static LRESULT CALLBACK wndproc(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam);
@@ -51,10 +109,13 @@ private:
   std::atomic<State> state_ = State::Uninitialized;
   std::atomic<bool> visible_ = true;
   std::thread init_thread_;
+  std::mutex init_mutex_;
+  std::condition_variable init_cv_; // Wakes the init thread out of its backoff on shutdown
 
   Hook<EndScene_t> endscene_;
   Hook<Reset_t> reset_;
   IDirect3DDevice9 *device_ = nullptr;
+  std::unique_ptr<Renderer> renderer_;
 
   HWND hwnd_ = nullptr;
   WNDPROC original_wndproc_ = nullptr;
@@ -62,6 +123,49 @@ private:
 
   // Frames are split, so Lua will prepare a frame and queue its draw data, and then
   // Overlay will render it in the next call to EndScene, so it is undetectable/grabbable.
+  // Finished frames are copied into a triple buffer, so EndScene never sees a half-built one.
   bool frame_started_ = false;
-  bool frame_ready_ = false; // Draw data ready to render
+  bool hidden_frame_ = false; // Started while hidden, ended without producing draw data
+  SnapshotBuffer snapshots_;
+  WindowCache window_cache_;
+  std::atomic<bool> replay_requested_ = false; // Frame was unchanged, draw the last one again
+  DrawOptimizer draw_optimizer_;
+  FontLoader fonts_;
+  UserTextures textures_;
+  TextureSync texture_sync_; // Texture requests to the render thread, results back
+  IdCache id_cache_;
+  bool optimize_draws_ = true;
+
+  using Clock = std::chrono::steady_clock;
+  std::atomic<float> ui_rate_ = 0.0f;
+  std::atomic<float> active_rate_ = 0.0f;          // Rate the last frame was built at
+  Clock::time_point next_update_;                 // Lua thread only
+  std::atomic<Clock::rep> last_publish_ticks_ = 0; // Read by EndScene to stop replaying stale frames
+
+  // Hidden mode, the set is only touched from the Lua thread
+  std::unordered_set<std::string> hud_windows_;
+  std::atomic<bool> has_hud_windows_ = false;
+
+  // Input, wndproc only queues translated events, they reach ImGuiIO in new_frame
+  static constexpr uint8_t CAPTURE_MOUSE = 0x1;
+  static constexpr uint8_t CAPTURE_KEYBOARD = 0x2;
+  InputQueue input_;
+  std::vector<InputQueue::Event> input_batch_; // Lua thread only
+  InputRecorder recorder_;                     // Lua thread only
+  bool replaying_ = false;                     // Lua thread only, replay state of the last frame
+  std::atomic<uint8_t> capture_flags_ = 0;
+  std::atomic<int> mouse_cursor_ = ImGuiMouseCursor_Arrow; // Requested by ImGui, set by wndproc
+  Clock::time_point last_frame_time_;                      // Lua thread only
+
+  // Idle throttling
+  std::atomic<uint32_t> input_events_ = 0; // Bumped by wndproc for every input message
+  uint32_t seen_input_events_ = 0;
+  int idle_after_frames_ = 0;
+  float idle_rate_ = 0.0f;
+  int quiet_frames_ = 0;
+  bool throttled_ = false;
+  uint64_t last_frame_hash_ = 0;
+
+  Profiler profiler_;
+  Profiler::Clock::time_point build_start_; // Lua thread only, end of the last new_frame
 };
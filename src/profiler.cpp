@@ -0,0 +1,109 @@
+#include "profiler.hpp"
+#include <imgui.h>
+#include <algorithm>
+#include <cfloat>
+
+namespace {
+
+// Copies a track's window out in recording order, returns the number of samples
+int copy_samples(const std::atomic<float> *samples, uint32_t count, float *out) {
+  int n = static_cast<int>(std::min<uint32_t>(count, Profiler::HISTORY));
+  uint32_t first = count - n;
+  for (int i = 0; i < n; ++i) {
+    out[i] = samples[(first + i) % Profiler::HISTORY].load(std::memory_order_relaxed);
+  }
+  return n;
+}
+
+} // namespace
+
+const char *Profiler::phase_name(Phase phase) {
+  switch (phase) {
+  case Phase::NewFrame: return "new_frame";
+  case Phase::Build: return "build";
+  case Phase::Render: return "render";
+  case Phase::RenderDrawData: return "render_draw_data";
+  case Phase::EndScene: return "end_scene";
+  default: return "unknown";
+  }
+}
+
+void Profiler::set_enabled(bool enabled) {
+  if (enabled && !this->enabled()) {
+    for (auto &track : tracks_) {
+      track.count.store(0, std::memory_order_relaxed);
+    }
+  }
+  enabled_ = enabled;
+}
+
+void Profiler::record(Phase phase, Clock::time_point start, Clock::time_point end) {
+  auto &track = tracks_[static_cast<int>(phase)];
+  float ms = std::chrono::duration<float, std::milli>(end - start).count();
+  uint32_t count = track.count.load(std::memory_order_relaxed);
+  track.samples[count % HISTORY].store(ms, std::memory_order_relaxed);
+  track.count.store(count + 1, std::memory_order_release);
+}
+
+Profiler::Summary Profiler::summary(Phase phase) const {
+  const auto &track = tracks_[static_cast<int>(phase)];
+  float values[HISTORY];
+  int n = copy_samples(track.samples, track.count.load(std::memory_order_acquire), values);
+
+  Summary s;
+  s.samples = n;
+  if (n == 0)
+    return s;
+
+  s.last = values[n - 1];
+  std::sort(values, values + n);
+  s.p50 = values[n / 2];
+  s.p99 = values[std::min(n - 1, (n * 99) / 100)];
+  s.max = values[n - 1];
+  return s;
+}
+
+void Profiler::draw_window() {
+  bool open = true;
+  ImGui::SetNextWindowSize(ImVec2(420.0f, 0.0f), ImGuiCond_FirstUseEver);
+  if (ImGui::Begin("lje-imgui profiler", &open)) {
+    if (!enabled()) {
+      ImGui::TextDisabled("Profiling is disabled");
+    } else if (ImGui::BeginTable("phases", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp)) {
+      ImGui::TableSetupColumn("phase (ms)");
+      ImGui::TableSetupColumn("last");
+      ImGui::TableSetupColumn("p50");
+      ImGui::TableSetupColumn("p99");
+      ImGui::TableSetupColumn("max");
+      ImGui::TableHeadersRow();
+
+      for (int i = 0; i < PHASE_COUNT; ++i) {
+        auto phase = static_cast<Phase>(i);
+        Summary s = summary(phase);
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(phase_name(phase));
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", s.last);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", s.p50);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", s.p99);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", s.max);
+      }
+      ImGui::EndTable();
+
+      float values[HISTORY];
+      for (auto phase : {Phase::Build, Phase::EndScene}) {
+        const auto &track = tracks_[static_cast<int>(phase)];
+        int n = copy_samples(track.samples, track.count.load(std::memory_order_acquire), values);
+        ImGui::PlotLines(phase_name(phase), values, n, 0, nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 48.0f));
+      }
+    }
+  }
+  ImGui::End();
+
+  if (!open)
+    window_shown_ = false;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// Per-phase frame timings kept in rolling windows. Each phase is written by one thread
+// only (Lua or D3D), readers may see a sample being replaced but never a torn one.
+// While disabled, scopes do not even read the clock.
+class Profiler {
+public:
+  enum class Phase {
+    NewFrame,       // Overlay::new_frame
+    Build,          // Lua widget calls, from new_frame returning to render being called
+    Render,         // EndFrame, Render and snapshot capture
+    RenderDrawData, // Drawing the snapshot inside EndScene
+    EndScene,       // Whole hooked EndScene, including the game's own
+    Count
+  };
+
+  static constexpr int PHASE_COUNT = static_cast<int>(Phase::Count);
+  static constexpr int HISTORY = 256;
+
+  // Milliseconds over the samples currently in the window
+  struct Summary {
+    float last = 0.0f;
+    float p50 = 0.0f;
+    float p99 = 0.0f;
+    float max = 0.0f;
+    int samples = 0;
+  };
+
+  using Clock = std::chrono::steady_clock;
+
+  class Scope {
+  public:
+    Scope(Profiler &profiler, Phase phase)
+      : profiler_(profiler.enabled() ? &profiler : nullptr), phase_(phase) {
+      if (profiler_)
+        start_ = Clock::now();
+    }
+    ~Scope() {
+      if (profiler_)
+        profiler_->record(phase_, start_, Clock::now());
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    Profiler *profiler_;
+    Phase phase_;
+    Clock::time_point start_;
+  };
+
+  static const char *phase_name(Phase phase);
+
+  // Enabling starts from empty windows
+  void set_enabled(bool enabled);
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  void set_window_shown(bool shown) { window_shown_ = shown; }
+  bool window_shown() const { return window_shown_; }
+
+  void record(Phase phase, Clock::time_point start, Clock::time_point end);
+  Summary summary(Phase phase) const;
+
+  // Native profiler window, called from within a frame on the Lua thread
+  void draw_window();
+
+private:
+  struct Track {
+    std::atomic<float> samples[HISTORY] = {};
+    std::atomic<uint32_t> count = 0; // Total recorded, the write position is count % HISTORY
+  };
+
+  std::atomic<bool> enabled_ = false;
+  std::atomic<bool> window_shown_ = false;
+  Track tracks_[PHASE_COUNT];
+};
@@ -0,0 +1,382 @@
+#include "dx9_renderer.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+struct Vertex {
+  float pos[3];
+  D3DCOLOR col;
+  float uv[2];
+};
+
+constexpr DWORD VERTEX_FVF = D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1;
+constexpr D3DFORMAT INDEX_FORMAT = sizeof(ImDrawIdx) == 2 ? D3DFMT_INDEX16 : D3DFMT_INDEX32;
+
+// ImGui packs colors as ABGR, the fixed-function pipeline wants ARGB
+D3DCOLOR to_d3d_color(ImU32 col) {
+#ifdef IMGUI_USE_BGRA_PACKED_COLOR
+  return col;
+#else
+  return (col & 0xFF00FF00) | ((col & 0xFF0000) >> 16) | ((col & 0xFF) << 16);
+#endif
+}
+
+// Texture pixels are RGBA32 bytes, D3DFMT_A8R8G8B8 is BGRA in memory
+void copy_pixels(unsigned char *dst, const unsigned char *src, int count) {
+  for (int i = 0; i < count; ++i, dst += 4, src += 4) {
+    dst[0] = src[2];
+    dst[1] = src[1];
+    dst[2] = src[0];
+    dst[3] = src[3];
+  }
+}
+
+IDirect3DTexture9 *to_d3d_texture(ImTextureID id) {
+  return reinterpret_cast<IDirect3DTexture9 *>(static_cast<uintptr_t>(id));
+}
+
+} // namespace
+
+bool Dx9Renderer::init() {
+  if (!state_.create(device_, VERTEX_FVF))
+    return false;
+
+  auto &io = ImGui::GetIO();
+  io.BackendRendererName = "lje_imgui_dx9";
+  io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+  io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures;
+  return true;
+}
+
+void Dx9Renderer::shutdown() {
+  release_buffers();
+  state_.release();
+  while (!textures_.empty())
+    destroy_texture(textures_.back());
+
+  auto &io = ImGui::GetIO();
+  io.BackendRendererName = nullptr;
+  io.BackendFlags &= ~(ImGuiBackendFlags_RendererHasVtxOffset | ImGuiBackendFlags_RendererHasTextures);
+}
+
+void Dx9Renderer::update_textures(std::vector<TextureRequest> &requests) {
+  for (TextureRequest &request : requests) {
+    switch (request.status) {
+    case ImTextureStatus_WantCreate:
+      create_texture(request);
+      break;
+    case ImTextureStatus_WantUpdates:
+      update_texture(request);
+      break;
+    case ImTextureStatus_WantDestroy:
+      destroy_texture(request.proxy);
+      request.applied = true;
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+void Dx9Renderer::render(ImDrawData *draw_data) {
+  // Texture uploads made by update_textures() count towards the frame they precede
+  draw(draw_data);
+  publish(stats_);
+  stats_ = {};
+}
+
+void Dx9Renderer::draw(ImDrawData *draw_data) {
+  // Avoid rendering when minimized
+  if (draw_data->DisplaySize.x <= 0.0f || draw_data->DisplaySize.y <= 0.0f)
+    return;
+
+  if (draw_data->TotalVtxCount == 0 || draw_data->TotalIdxCount == 0)
+    return;
+
+  uint32_t vtx_base, idx_base;
+  if (!reserve_buffers(draw_data->TotalVtxCount, draw_data->TotalIdxCount) ||
+      !upload(draw_data, vtx_base, idx_base))
+    return;
+
+  if (!state_.ready() && !state_.create(device_, VERTEX_FVF))
+    return;
+
+  // Backup only the states the overlay changes, then apply the prerecorded setup
+  state_.save();
+  setup_render_state(draw_data);
+  stats_.state_calls += 1;
+
+  ImVec2 clip_off = draw_data->DisplayPos;
+  ImTextureID last_texture = ImTextureID_Invalid;
+  RECT last_scissor = {};
+  bool have_texture = false;
+  bool have_scissor = false;
+
+  uint32_t list_vtx_offset = 0;
+  uint32_t list_idx_offset = 0;
+  for (const ImDrawList *list : draw_data->CmdLists) {
+    for (const ImDrawCmd &cmd : list->CmdBuffer) {
+      if (cmd.UserCallback) {
+        // ImDrawCallback_ResetRenderState is a special value asking to reset the render state
+        if (cmd.UserCallback == ImDrawCallback_ResetRenderState)
+          setup_render_state(draw_data);
+        else
+          cmd.UserCallback(list, &cmd);
+        have_texture = have_scissor = false;
+        continue;
+      }
+
+      ImVec2 clip_min(cmd.ClipRect.x - clip_off.x, cmd.ClipRect.y - clip_off.y);
+      ImVec2 clip_max(cmd.ClipRect.z - clip_off.x, cmd.ClipRect.w - clip_off.y);
+      if (clip_max.x <= clip_min.x || clip_max.y <= clip_min.y)
+        continue;
+
+      // A texture that is gone or failed to upload leaves its commands undrawn
+      ImTextureID texture = cmd.TexRef._TexData ? cmd.TexRef._TexData->TexID : cmd.TexRef._TexID;
+      if (texture == ImTextureID_Invalid)
+        continue;
+
+      // Consecutive commands mostly share the font texture and often the clip rect
+      if (!have_texture || texture != last_texture) {
+        device_->SetTexture(0, to_d3d_texture(texture));
+        last_texture = texture;
+        have_texture = true;
+        stats_.state_calls++;
+      }
+
+      RECT r = {static_cast<LONG>(clip_min.x), static_cast<LONG>(clip_min.y),
+                static_cast<LONG>(clip_max.x), static_cast<LONG>(clip_max.y)};
+      if (!have_scissor || memcmp(&r, &last_scissor, sizeof(RECT)) != 0) {
+        device_->SetScissorRect(&r);
+        last_scissor = r;
+        have_scissor = true;
+        stats_.state_calls++;
+      }
+
+      device_->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, vtx_base + list_vtx_offset + cmd.VtxOffset,
+                                    0, static_cast<UINT>(list->VtxBuffer.Size),
+                                    idx_base + list_idx_offset + cmd.IdxOffset, cmd.ElemCount / 3);
+      stats_.draw_calls++;
+    }
+    list_vtx_offset += list->VtxBuffer.Size;
+    list_idx_offset += list->IdxBuffer.Size;
+  }
+
+  state_.restore();
+  stats_.state_calls++;
+}
+
+void Dx9Renderer::invalidate_device_objects(std::vector<ImTextureData *> &lost) {
+  release_buffers();
+  state_.release();
+
+  // D3DPOOL_DEFAULT textures don't survive a reset, TextureSync recreates them
+  for (ImTextureData *proxy : textures_) {
+    to_d3d_texture(proxy->TexID)->Release();
+    proxy->SetTexID(ImTextureID_Invalid);
+    lost.push_back(proxy);
+  }
+  textures_.clear();
+}
+
+bool Dx9Renderer::create_device_objects() {
+  // Ring buffers are recreated on the next render, sized from the high-water mark
+  return state_.create(device_, VERTEX_FVF);
+}
+
+void Dx9Renderer::create_texture(TextureRequest &request) {
+  destroy_texture(request.proxy);
+
+  IDirect3DTexture9 *texture = nullptr;
+  if (device_->CreateTexture(request.width, request.height, 1, D3DUSAGE_DYNAMIC, D3DFMT_A8R8G8B8, D3DPOOL_DEFAULT,
+                             &texture, nullptr) < 0)
+    return;
+
+  ImTextureRect all = {0, 0, static_cast<unsigned short>(request.width), static_cast<unsigned short>(request.height)};
+  if (!write_texture(texture, &all, 1, request.pixels.data())) {
+    texture->Release();
+    return;
+  }
+
+  request.proxy->SetTexID(static_cast<ImTextureID>(reinterpret_cast<uintptr_t>(texture)));
+  textures_.push_back(request.proxy);
+  request.applied = true;
+  request.tex_id = request.proxy->TexID;
+}
+
+void Dx9Renderer::update_texture(TextureRequest &request) {
+  if (request.proxy->TexID == ImTextureID_Invalid)
+    return;
+
+  if (write_texture(to_d3d_texture(request.proxy->TexID), request.rects.data(), static_cast<int>(request.rects.size()),
+                    request.pixels.data())) {
+    request.applied = true;
+    request.tex_id = request.proxy->TexID;
+  }
+}
+
+void Dx9Renderer::destroy_texture(ImTextureData *proxy) {
+  if (proxy->TexID == ImTextureID_Invalid)
+    return;
+
+  to_d3d_texture(proxy->TexID)->Release();
+  proxy->SetTexID(ImTextureID_Invalid);
+  textures_.erase(std::find(textures_.begin(), textures_.end(), proxy));
+}
+
+// Writes rects, whose pixels are packed back to back, with one lock over their bounds
+bool Dx9Renderer::write_texture(IDirect3DTexture9 *texture, const ImTextureRect *rects, int count,
+                                const unsigned char *pixels) {
+  if (count == 0)
+    return true;
+
+  RECT bounds = {rects[0].x, rects[0].y, rects[0].x + rects[0].w, rects[0].y + rects[0].h};
+  for (int i = 1; i < count; ++i) {
+    bounds.left = (std::min)(bounds.left, static_cast<LONG>(rects[i].x));
+    bounds.top = (std::min)(bounds.top, static_cast<LONG>(rects[i].y));
+    bounds.right = (std::max)(bounds.right, static_cast<LONG>(rects[i].x + rects[i].w));
+    bounds.bottom = (std::max)(bounds.bottom, static_cast<LONG>(rects[i].y + rects[i].h));
+  }
+
+  D3DLOCKED_RECT locked;
+  if (texture->LockRect(0, &locked, &bounds, 0) < 0)
+    return false;
+  stats_.locks++;
+
+  auto base = static_cast<unsigned char *>(locked.pBits);
+  for (int i = 0; i < count; ++i) {
+    const ImTextureRect &r = rects[i];
+    for (int row = 0; row < r.h; ++row) {
+      unsigned char *dst = base + static_cast<size_t>(r.y - bounds.top + row) * locked.Pitch +
+                           static_cast<size_t>(r.x - bounds.left) * 4;
+      copy_pixels(dst, pixels, r.w);
+      pixels += static_cast<size_t>(r.w) * 4;
+    }
+    stats_.bytes_uploaded += static_cast<uint32_t>(r.w) * r.h * 4;
+  }
+
+  texture->UnlockRect(0);
+  return true;
+}
+
+bool Dx9Renderer::reserve_buffers(uint32_t vtx_count, uint32_t idx_count) {
+  if (!vb_ || !vtx_ring_.fits(vtx_count)) {
+    if (vb_) {
+      vb_->Release();
+      vb_ = nullptr;
+    }
+    uint32_t capacity = vtx_ring_.capacity_for(vtx_count);
+    if (device_->CreateVertexBuffer(capacity * sizeof(Vertex), D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY,
+                                    VERTEX_FVF, D3DPOOL_DEFAULT, &vb_, nullptr) < 0) {
+      vb_ = nullptr;
+      vtx_ring_.invalidate();
+      return false;
+    }
+    vtx_ring_.reset(capacity);
+    stats_.buffer_creates++;
+  }
+
+  if (!ib_ || !idx_ring_.fits(idx_count)) {
+    if (ib_) {
+      ib_->Release();
+      ib_ = nullptr;
+    }
+    uint32_t capacity = idx_ring_.capacity_for(idx_count);
+    if (device_->CreateIndexBuffer(capacity * sizeof(ImDrawIdx), D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY,
+                                   INDEX_FORMAT, D3DPOOL_DEFAULT, &ib_, nullptr) < 0) {
+      ib_ = nullptr;
+      idx_ring_.invalidate();
+      return false;
+    }
+    idx_ring_.reset(capacity);
+    stats_.buffer_creates++;
+  }
+
+  return true;
+}
+
+bool Dx9Renderer::upload(ImDrawData *draw_data, uint32_t &vtx_base, uint32_t &idx_base) {
+  uint32_t vtx_count = draw_data->TotalVtxCount;
+  uint32_t idx_count = draw_data->TotalIdxCount;
+  auto vtx_span = vtx_ring_.allocate(vtx_count);
+  auto idx_span = idx_ring_.allocate(idx_count);
+
+  Vertex *vtx_dst = nullptr;
+  ImDrawIdx *idx_dst = nullptr;
+  if (vb_->Lock(vtx_span.offset * sizeof(Vertex), vtx_count * sizeof(Vertex),
+                reinterpret_cast<void **>(&vtx_dst),
+                vtx_span.discard ? D3DLOCK_DISCARD : D3DLOCK_NOOVERWRITE) < 0) {
+    vtx_ring_.invalidate();
+    return false;
+  }
+  if (ib_->Lock(idx_span.offset * sizeof(ImDrawIdx), idx_count * sizeof(ImDrawIdx),
+                reinterpret_cast<void **>(&idx_dst),
+                idx_span.discard ? D3DLOCK_DISCARD : D3DLOCK_NOOVERWRITE) < 0) {
+    vb_->Unlock();
+    idx_ring_.invalidate();
+    return false;
+  }
+  stats_.locks += 2;
+  stats_.bytes_uploaded += vtx_count * sizeof(Vertex) + idx_count * sizeof(ImDrawIdx);
+
+  for (const ImDrawList *list : draw_data->CmdLists) {
+    for (const ImDrawVert &v : list->VtxBuffer) {
+      vtx_dst->pos[0] = v.pos.x;
+      vtx_dst->pos[1] = v.pos.y;
+      vtx_dst->pos[2] = 0.0f;
+      vtx_dst->col = to_d3d_color(v.col);
+      vtx_dst->uv[0] = v.uv.x;
+      vtx_dst->uv[1] = v.uv.y;
+      vtx_dst++;
+    }
+    memcpy(idx_dst, list->IdxBuffer.Data, list->IdxBuffer.size_in_bytes());
+    idx_dst += list->IdxBuffer.Size;
+  }
+
+  vb_->Unlock();
+  ib_->Unlock();
+
+  vtx_base = vtx_span.offset;
+  idx_base = idx_span.offset;
+  return true;
+}
+
+void Dx9Renderer::setup_render_state(ImDrawData *draw_data) {
+  state_.apply_setup();
+
+  D3DVIEWPORT9 vp;
+  vp.X = vp.Y = 0;
+  vp.Width = static_cast<DWORD>(draw_data->DisplaySize.x);
+  vp.Height = static_cast<DWORD>(draw_data->DisplaySize.y);
+  vp.MinZ = 0.0f;
+  vp.MaxZ = 1.0f;
+  device_->SetViewport(&vp);
+
+  // Orthographic projection, half-pixel offset for D3D9 texel/pixel alignment
+  float l = draw_data->DisplayPos.x + 0.5f;
+  float r = draw_data->DisplayPos.x + draw_data->DisplaySize.x + 0.5f;
+  float t = draw_data->DisplayPos.y + 0.5f;
+  float b = draw_data->DisplayPos.y + draw_data->DisplaySize.y + 0.5f;
+  D3DMATRIX projection = {{{2.0f / (r - l), 0.0f, 0.0f, 0.0f, 0.0f, 2.0f / (t - b), 0.0f, 0.0f,
+                            0.0f, 0.0f, 0.5f, 0.0f, (l + r) / (l - r), (t + b) / (b - t), 0.5f,
+                            1.0f}}};
+  device_->SetTransform(D3DTS_PROJECTION, &projection);
+
+  device_->SetStreamSource(0, vb_, 0, sizeof(Vertex));
+  device_->SetIndices(ib_);
+  stats_.state_calls += 5;
+}
+
+void Dx9Renderer::release_buffers() {
+  if (vb_) {
+    vb_->Release();
+    vb_ = nullptr;
+  }
+  if (ib_) {
+    ib_->Release();
+    ib_ = nullptr;
+  }
+  vtx_ring_.invalidate();
+  idx_ring_.invalidate();
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <d3d9.h>
+#include <cstdint>
+#include <vector>
+#include "renderer.hpp"
+#include "ring_allocator.hpp"
+#include "dx9_state.hpp"
+
+// D3D9 backend. Draw data is submitted through persistent ring-buffered vertex/index
+// buffers, textures are created and updated from the TextureRequests of each frame.
+// The stock ImGui DX9 backend is not used, it works on the live ImTextureData.
+class Dx9Renderer : public Renderer {
+public:
+  explicit Dx9Renderer(IDirect3DDevice9 *dev)
+    : device_(dev) {}
+
+  const char *name() const override { return "dx9"; }
+
+  bool init() override;
+  void shutdown() override;
+
+  void new_frame() override {}
+  void update_textures(std::vector<TextureRequest> &requests) override;
+  void render(ImDrawData *draw_data) override;
+
+  void invalidate_device_objects(std::vector<ImTextureData *> &lost) override;
+  bool create_device_objects() override;
+
+private:
+  void create_texture(TextureRequest &request);
+  void update_texture(TextureRequest &request);
+  void destroy_texture(ImTextureData *proxy);
+  bool write_texture(IDirect3DTexture9 *texture, const ImTextureRect *rects, int count, const unsigned char *pixels);
+  void draw(ImDrawData *draw_data);
+  bool reserve_buffers(uint32_t vtx_count, uint32_t idx_count);
+  bool upload(ImDrawData *draw_data, uint32_t &vtx_base, uint32_t &idx_base);
+  void setup_render_state(ImDrawData *draw_data);
+  void release_buffers();
+
+  IDirect3DDevice9 *device_;
+  IDirect3DVertexBuffer9 *vb_ = nullptr;
+  IDirect3DIndexBuffer9 *ib_ = nullptr;
+  RingAllocator vtx_ring_{5000};
+  RingAllocator idx_ring_{10000};
+  Dx9RenderState state_;
+  std::vector<ImTextureData *> textures_; // Proxies that own a device texture
+  FrameStats stats_; // Render thread only, published when render() returns
+};
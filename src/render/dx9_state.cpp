@@ -0,0 +1,101 @@
+#include "dx9_state.hpp"
+
+bool Dx9RenderState::create(IDirect3DDevice9 *dev, DWORD fvf) {
+  release();
+
+  // Recorded calls are not applied to the device, only their state slots are remembered
+  if (dev->BeginStateBlock() < 0)
+    return false;
+  record_setup_states(dev, fvf);
+  record_frame_states(dev);
+  if (dev->EndStateBlock(&saved_) < 0) {
+    saved_ = nullptr;
+    return false;
+  }
+
+  if (dev->BeginStateBlock() < 0) {
+    release();
+    return false;
+  }
+  record_setup_states(dev, fvf);
+  if (dev->EndStateBlock(&setup_) < 0) {
+    setup_ = nullptr;
+    release();
+    return false;
+  }
+
+  return true;
+}
+
+void Dx9RenderState::release() {
+  if (saved_) {
+    saved_->Release();
+    saved_ = nullptr;
+  }
+  if (setup_) {
+    setup_->Release();
+    setup_ = nullptr;
+  }
+}
+
+void Dx9RenderState::record_setup_states(IDirect3DDevice9 *dev, DWORD fvf) {
+  static const D3DMATRIX identity = {{{1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+                                       1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f}}};
+
+  // Fixed-pipeline, alpha-blending, no face culling, no depth testing, gouraud shading, bilinear sampling
+  dev->SetPixelShader(nullptr);
+  dev->SetVertexShader(nullptr);
+  dev->SetFVF(fvf);
+  dev->SetRenderState(D3DRS_FILLMODE, D3DFILL_SOLID);
+  dev->SetRenderState(D3DRS_SHADEMODE, D3DSHADE_GOURAUD);
+  dev->SetRenderState(D3DRS_ZWRITEENABLE, FALSE);
+  dev->SetRenderState(D3DRS_ALPHATESTENABLE, FALSE);
+  dev->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+  dev->SetRenderState(D3DRS_ZENABLE, FALSE);
+  dev->SetRenderState(D3DRS_ALPHABLENDENABLE, TRUE);
+  dev->SetRenderState(D3DRS_BLENDOP, D3DBLENDOP_ADD);
+  dev->SetRenderState(D3DRS_SRCBLEND, D3DBLEND_SRCALPHA);
+  dev->SetRenderState(D3DRS_DESTBLEND, D3DBLEND_INVSRCALPHA);
+  dev->SetRenderState(D3DRS_SEPARATEALPHABLENDENABLE, TRUE);
+  dev->SetRenderState(D3DRS_SRCBLENDALPHA, D3DBLEND_ONE);
+  dev->SetRenderState(D3DRS_DESTBLENDALPHA, D3DBLEND_INVSRCALPHA);
+  dev->SetRenderState(D3DRS_SCISSORTESTENABLE, TRUE);
+  dev->SetRenderState(D3DRS_FOGENABLE, FALSE);
+  dev->SetRenderState(D3DRS_RANGEFOGENABLE, FALSE);
+  dev->SetRenderState(D3DRS_SPECULARENABLE, FALSE);
+  dev->SetRenderState(D3DRS_STENCILENABLE, FALSE);
+  dev->SetRenderState(D3DRS_CLIPPING, TRUE);
+  dev->SetRenderState(D3DRS_LIGHTING, FALSE);
+  dev->SetRenderState(D3DRS_SRGBWRITEENABLE, FALSE);
+  dev->SetTextureStageState(0, D3DTSS_COLOROP, D3DTOP_MODULATE);
+  dev->SetTextureStageState(0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+  dev->SetTextureStageState(0, D3DTSS_COLORARG2, D3DTA_DIFFUSE);
+  dev->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_MODULATE);
+  dev->SetTextureStageState(0, D3DTSS_ALPHAARG1, D3DTA_TEXTURE);
+  dev->SetTextureStageState(0, D3DTSS_ALPHAARG2, D3DTA_DIFFUSE);
+  dev->SetTextureStageState(0, D3DTSS_TEXCOORDINDEX, 0);
+  dev->SetTextureStageState(1, D3DTSS_COLOROP, D3DTOP_DISABLE);
+  dev->SetTextureStageState(1, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
+  dev->SetSamplerState(0, D3DSAMP_MINFILTER, D3DTEXF_LINEAR);
+  dev->SetSamplerState(0, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);
+  dev->SetSamplerState(0, D3DSAMP_ADDRESSU, D3DTADDRESS_CLAMP);
+  dev->SetSamplerState(0, D3DSAMP_ADDRESSV, D3DTADDRESS_CLAMP);
+  dev->SetSamplerState(0, D3DSAMP_SRGBTEXTURE, FALSE);
+  dev->SetTransform(D3DTS_WORLD, &identity);
+  dev->SetTransform(D3DTS_VIEW, &identity);
+}
+
+// States the renderer sets per frame or per draw, only recorded so save/restore cover them
+void Dx9RenderState::record_frame_states(IDirect3DDevice9 *dev) {
+  static const D3DMATRIX identity = {{{1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+                                       1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f}}};
+  D3DVIEWPORT9 vp = {0, 0, 1, 1, 0.0f, 1.0f};
+  RECT scissor = {0, 0, 1, 1};
+
+  dev->SetViewport(&vp);
+  dev->SetTransform(D3DTS_PROJECTION, &identity);
+  dev->SetStreamSource(0, nullptr, 0, 0);
+  dev->SetIndices(nullptr);
+  dev->SetTexture(0, nullptr);
+  dev->SetScissorRect(&scissor);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <d3d9.h>
+
+// State blocks for drawing the overlay in the middle of the game's frame. Both blocks are
+// recorded once per device (and again after a Reset) and cover only the states the
+// overlay changes, instead of creating and capturing a D3DSBT_ALL block every frame.
+class Dx9RenderState {
+public:
+  bool create(IDirect3DDevice9 *dev, DWORD fvf);
+  void release();
+
+  bool ready() const { return saved_ && setup_; }
+
+  // Snapshot the game's values of every state the overlay touches
+  void save() { saved_->Capture(); }
+
+  // Fixed-function pipeline setup for ImGui, everything except viewport, projection and
+  // the vertex/index buffers which change with the frame
+  void apply_setup() { setup_->Apply(); }
+
+  // Put the game's values back
+  void restore() { saved_->Apply(); }
+
+private:
+  static void record_setup_states(IDirect3DDevice9 *dev, DWORD fvf);
+  static void record_frame_states(IDirect3DDevice9 *dev);
+
+  IDirect3DStateBlock9 *saved_ = nullptr;
+  IDirect3DStateBlock9 *setup_ = nullptr;
+};
@@ -0,0 +1,119 @@
+#include "null_renderer.hpp"
+#include <algorithm>
+#include <cstring>
+
+bool NullRenderer::init() {
+  auto &io = ImGui::GetIO();
+  io.BackendRendererName = "lje_imgui_null";
+  io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+  io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures;
+  return true;
+}
+
+void NullRenderer::shutdown() {
+  while (!textures_.empty())
+    destroy_texture(textures_.back());
+
+  auto &io = ImGui::GetIO();
+  io.BackendRendererName = nullptr;
+  io.BackendFlags &= ~(ImGuiBackendFlags_RendererHasVtxOffset | ImGuiBackendFlags_RendererHasTextures);
+}
+
+void NullRenderer::update_textures(std::vector<TextureRequest> &requests) {
+  Stats &stats = textures_since_render_;
+  for (TextureRequest &request : requests) {
+    switch (request.status) {
+    case ImTextureStatus_WantCreate:
+      destroy_texture(request.proxy);
+      request.proxy->SetTexID(static_cast<ImTextureID>(next_texture_id_++));
+      textures_.push_back(request.proxy);
+      ++stats.texture_creates;
+      stats.texture_bytes += request.pixels.size();
+      break;
+    case ImTextureStatus_WantUpdates:
+      if (request.proxy->TexID == ImTextureID_Invalid)
+        continue;
+      stats.texture_updates += request.rects.size();
+      stats.texture_bytes += request.pixels.size();
+      break;
+    case ImTextureStatus_WantDestroy:
+      destroy_texture(request.proxy);
+      break;
+    default:
+      continue;
+    }
+    request.applied = true;
+    request.tex_id = request.proxy->TexID;
+  }
+}
+
+void NullRenderer::render(ImDrawData *draw_data) {
+  last_frame_ = textures_since_render_;
+  textures_since_render_ = {};
+  last_frame_.frames = 1;
+
+  last_frame_.vertices = draw_data->TotalVtxCount;
+  last_frame_.indices = draw_data->TotalIdxCount;
+
+  // Device calls are counted the way Dx9Renderer makes them, so both report comparable stats
+  FrameStats device;
+  ImTextureID last_texture = ImTextureID_Invalid;
+  ImVec4 last_clip;
+  bool have_state = false;
+  for (const ImDrawList *list : draw_data->CmdLists) {
+    for (const ImDrawCmd &cmd : list->CmdBuffer) {
+      if (cmd.UserCallback) {
+        ++last_frame_.callbacks;
+        have_state = false;
+        continue;
+      }
+      ImTextureID texture = cmd.TexRef._TexData ? cmd.TexRef._TexData->TexID : cmd.TexRef._TexID;
+      if (cmd.ElemCount == 0 || texture == ImTextureID_Invalid)
+        continue;
+
+      ++last_frame_.draw_calls;
+      if (!have_state || texture != last_texture)
+        ++device.state_calls;
+      if (!have_state || memcmp(&cmd.ClipRect, &last_clip, sizeof(ImVec4)) != 0)
+        ++device.state_calls;
+      last_texture = texture;
+      last_clip = cmd.ClipRect;
+      have_state = true;
+    }
+  }
+
+  device.draw_calls = static_cast<uint32_t>(last_frame_.draw_calls);
+  if (last_frame_.vertices > 0 && last_frame_.indices > 0) {
+    device.locks = 2;
+    device.bytes_uploaded =
+      static_cast<uint32_t>(last_frame_.vertices * sizeof(ImDrawVert) + last_frame_.indices * sizeof(ImDrawIdx));
+  }
+  device.locks += static_cast<uint32_t>(last_frame_.texture_creates + last_frame_.texture_updates);
+  device.bytes_uploaded += static_cast<uint32_t>(last_frame_.texture_bytes);
+  publish(device);
+
+  totals_.frames += last_frame_.frames;
+  totals_.draw_calls += last_frame_.draw_calls;
+  totals_.callbacks += last_frame_.callbacks;
+  totals_.vertices += last_frame_.vertices;
+  totals_.indices += last_frame_.indices;
+  totals_.texture_creates += last_frame_.texture_creates;
+  totals_.texture_updates += last_frame_.texture_updates;
+  totals_.texture_bytes += last_frame_.texture_bytes;
+}
+
+void NullRenderer::invalidate_device_objects(std::vector<ImTextureData *> &lost) {
+  for (ImTextureData *proxy : textures_) {
+    proxy->SetTexID(ImTextureID_Invalid);
+    lost.push_back(proxy);
+  }
+  textures_.clear();
+}
+
+void NullRenderer::destroy_texture(ImTextureData *proxy) {
+  if (proxy->TexID == ImTextureID_Invalid)
+    return;
+
+  proxy->SetTexID(ImTextureID_Invalid);
+  textures_.erase(std::find(textures_.begin(), textures_.end(), proxy));
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "renderer.hpp"
+
+// Headless backend that draws nothing and records what a real device would have been
+// asked to do. Lets the frame pipeline run and be measured without D3D9; the counts are
+// also published as FrameStats, so imgui.get_frame_stats reports them.
+class NullRenderer : public Renderer {
+public:
+  struct Stats {
+    uint64_t frames = 0;
+    uint64_t draw_calls = 0;
+    uint64_t callbacks = 0;
+    uint64_t vertices = 0;
+    uint64_t indices = 0;
+    uint64_t texture_creates = 0;
+    uint64_t texture_updates = 0;
+    uint64_t texture_bytes = 0;
+  };
+
+  const char *name() const override { return "null"; }
+
+  bool init() override;
+  void shutdown() override;
+
+  void new_frame() override {}
+  void update_textures(std::vector<TextureRequest> &requests) override;
+  void render(ImDrawData *draw_data) override;
+
+  void invalidate_device_objects(std::vector<ImTextureData *> &lost) override;
+  bool create_device_objects() override { return true; }
+
+  // Totals since init, and the counts for the most recent render() call only
+  const Stats &totals() const { return totals_; }
+  const Stats &last_frame() const { return last_frame_; }
+  void reset_stats() { totals_ = {}; last_frame_ = {}; }
+
+private:
+  void destroy_texture(ImTextureData *proxy);
+
+  Stats totals_;
+  Stats last_frame_;
+  Stats textures_since_render_; // Texture counts of update_textures(), moved into the next frame
+  uint64_t next_texture_id_ = 1;
+  std::vector<ImTextureData *> textures_; // Proxies with a fake device texture
+};
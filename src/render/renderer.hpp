@@ -0,0 +1,58 @@
+#pragma once
+#include <imgui.h>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "../draw_snapshot.hpp"
+
+// Graphics backend behind Overlay. The overlay builds and snapshots frames the same way
+// regardless of backend, this is only the part that talks to a device.
+class Renderer {
+public:
+  // Device work done by the last render() call and the texture updates before it
+  struct FrameStats {
+    uint32_t draw_calls = 0;
+    uint32_t state_calls = 0;    // Set*/Capture/Apply calls made on the device
+    uint32_t locks = 0;          // Vertex/index buffer and texture locks
+    uint32_t bytes_uploaded = 0; // Vertex, index and texture data written to the device
+    uint32_t buffer_creates = 0;
+  };
+
+  virtual ~Renderer() = default;
+
+  virtual const char *name() const = 0;
+
+  virtual bool init() = 0;
+  virtual void shutdown() = 0;
+
+  virtual void new_frame() = 0;
+
+  // Applies the texture requests of a newly acquired frame before it is drawn, setting
+  // applied and tex_id on each one that succeeded. Only ever touches the proxies.
+  virtual void update_textures(std::vector<TextureRequest> &requests) = 0;
+
+  // Draw commands reference textures through proxies, a command whose proxy has no device
+  // texture is skipped. draw_data->Textures is never read.
+  virtual void render(ImDrawData *draw_data) = 0;
+
+  // Device loss (D3D9 Reset) - release and recreate anything that lives in device memory.
+  // Proxies whose device texture was released are appended to lost.
+  virtual void invalidate_device_objects(std::vector<ImTextureData *> &lost) = 0;
+  virtual bool create_device_objects() = 0;
+
+  // Published by render() on the render thread, safe to read from the Lua thread
+  FrameStats frame_stats() const {
+    std::lock_guard lock(stats_mutex_);
+    return frame_stats_;
+  }
+
+protected:
+  void publish(const FrameStats &stats) {
+    std::lock_guard lock(stats_mutex_);
+    frame_stats_ = stats;
+  }
+
+private:
+  mutable std::mutex stats_mutex_;
+  FrameStats frame_stats_;
+};
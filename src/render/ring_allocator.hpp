@@ -0,0 +1,76 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+// Allocation policy for a dynamic vertex/index buffer that is reused across frames.
+// Frames are appended behind each other (lock with NOOVERWRITE, the GPU may still be
+// reading the earlier ranges) and the ring wraps to the start with DISCARD once the end
+// is reached. Capacity follows the high-water mark of per-frame usage, so the buffer is
+// only recreated while the UI is still growing, and at the right size after a reset.
+//
+// Knows nothing about D3D, the renderer owns the buffer and does the locking.
+class RingAllocator {
+public:
+  struct Span {
+    uint32_t offset = 0;
+    bool discard = false;
+  };
+
+  // Number of peak-sized frames that fit in the ring before it wraps
+  static constexpr uint32_t FRAMES_PER_RING = 3;
+
+  explicit RingAllocator(uint32_t min_capacity)
+    : min_capacity_(min_capacity) {}
+
+  uint32_t capacity() const { return capacity_; }
+  uint32_t high_water() const { return high_water_; }
+
+  // Capacity to create the backing buffer with, so that count elements and FRAMES_PER_RING
+  // frames at the high-water mark fit
+  uint32_t capacity_for(uint32_t count) const {
+    uint32_t want = (std::max)({min_capacity_, count, high_water_}) * FRAMES_PER_RING;
+    uint32_t capacity = 1;
+    while (capacity < want) {
+      capacity <<= 1;
+    }
+    return capacity;
+  }
+
+  // False once the buffer no longer holds FRAMES_PER_RING peak frames, not only when count
+  // itself doesn't fit, or a UI that grows slowly ends up discarding on every frame
+  bool fits(uint32_t count) const { return capacity_for(count) <= capacity_; }
+
+  // Backing buffer was (re)created, the first allocation has to discard
+  void reset(uint32_t capacity) {
+    capacity_ = capacity;
+    head_ = 0;
+    discard_next_ = true;
+  }
+
+  // Backing buffer was released, the high-water mark is kept for the next one
+  void invalidate() { reset(0); }
+
+  // count must fit in the current capacity
+  Span allocate(uint32_t count) {
+    high_water_ = (std::max)(high_water_, count);
+
+    Span span;
+    if (discard_next_ || head_ + count > capacity_) {
+      span.offset = 0;
+      span.discard = true;
+      head_ = 0;
+      discard_next_ = false;
+    } else {
+      span.offset = head_;
+    }
+    head_ += count;
+    return span;
+  }
+
+private:
+  uint32_t min_capacity_;
+  uint32_t capacity_ = 0;
+  uint32_t high_water_ = 0;
+  uint32_t head_ = 0;
+  bool discard_next_ = true;
+};
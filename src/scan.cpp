@@ -0,0 +1,191 @@
+#include "scan.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace scan {
+
+namespace {
+
+// Small enough to stay in L2 while every pattern is searched in it
+constexpr size_t CHUNK_SIZE = 256 * 1024;
+constexpr unsigned MAX_THREADS = 16;
+
+} // namespace
+
+Pattern parse(const char *pattern) {
+  Pattern result;
+
+  for (const char *p = pattern; *p; ++p) {
+    if (*p == ' ') continue;
+    if (*p == '?') {
+      result.bytes.push_back(0);
+      result.mask.push_back(0);
+      if (*(p + 1) == '?') ++p;
+    } else {
+      char byte[3] = { p[0], p[1], 0 };
+      result.bytes.push_back(static_cast<uint8_t>(strtoul(byte, nullptr, 16)));
+      result.mask.push_back(0xFF);
+      if (p[1]) ++p;
+    }
+  }
+
+  detail::pick_anchors(result.bytes.data(), result.mask.data(), result.size(), result.anchor, result.second);
+  return result;
+}
+
+const uint8_t *find_scalar(const uint8_t *data, size_t size, const Pattern &pattern) {
+  return detail::find_scalar<0>(data, size, pattern.view());
+}
+
+const uint8_t *find_sse2(const uint8_t *data, size_t size, const Pattern &pattern) {
+  return detail::find_sse2<0>(data, size, pattern.view());
+}
+
+const uint8_t *find_avx2(const uint8_t *data, size_t size, const Pattern &pattern) {
+  return detail::find_avx2<0>(data, size, pattern.view());
+}
+
+#if SCAN_X86
+
+bool has_sse2() {
+#if defined(_M_X64) || defined(__x86_64__)
+  return true;
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  return (info[3] & (1 << 26)) != 0;
+#else
+  return __builtin_cpu_supports("sse2");
+#endif
+}
+
+bool has_avx2() {
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+
+  // AVX2 also needs the OS to save YMM state
+  __cpuid(info, 1);
+  bool osxsave = (info[2] & (1 << 27)) != 0;
+  bool avx = (info[2] & (1 << 28)) != 0;
+  if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+    return false;
+
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#else
+
+bool has_sse2() { return false; }
+bool has_avx2() { return false; }
+
+#endif
+
+detail::Level detail::cpu_level() {
+  return has_avx2() ? Level::AVX2 : has_sse2() ? Level::SSE2 : Level::Scalar;
+}
+
+const uint8_t *find(const uint8_t *data, size_t size, const Pattern &pattern) {
+  return detail::find<0>(data, size, pattern.view());
+}
+
+std::vector<std::vector<size_t>> find_many(const uint8_t *data, size_t size, const std::vector<Pattern> &patterns,
+                                           Hits hits, unsigned threads) {
+  std::vector<std::vector<size_t>> results(patterns.size());
+  if (patterns.empty() || size == 0)
+    return results;
+
+  size_t chunks = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = static_cast<unsigned>(std::min<size_t>({threads, MAX_THREADS, chunks}));
+
+  // With Hits::First, chunks past a pattern's earliest match are skipped for it
+  std::vector<std::atomic<size_t>> first(patterns.size());
+  for (auto &f : first) {
+    f = SIZE_MAX;
+  }
+
+  std::atomic<size_t> next_chunk = 0;
+  std::mutex results_mutex;
+
+  auto worker = [&] {
+    std::vector<std::vector<size_t>> local(patterns.size());
+    for (;;) {
+      size_t chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+      if (chunk >= chunks)
+        break;
+
+      size_t begin = chunk * CHUNK_SIZE;
+      size_t end = std::min(size, begin + CHUNK_SIZE);
+      for (size_t p = 0; p < patterns.size(); ++p) {
+        const Pattern &pattern = patterns[p];
+        if (pattern.empty() || (hits == Hits::First && first[p].load(std::memory_order_relaxed) < begin))
+          continue;
+
+        // Matches must start inside the chunk but may extend into the next one
+        size_t limit = std::min(size, end + pattern.size() - 1);
+        size_t pos = begin;
+        while (pos < end) {
+          const uint8_t *found = find(data + pos, limit - pos, pattern);
+          if (!found)
+            break;
+          size_t offset = static_cast<size_t>(found - data);
+          if (offset >= end)
+            break;
+
+          if (hits == Hits::First) {
+            size_t current = first[p].load(std::memory_order_relaxed);
+            while (offset < current && !first[p].compare_exchange_weak(current, offset)) {
+            }
+            break;
+          }
+          local[p].push_back(offset);
+          pos = offset + 1;
+        }
+      }
+    }
+
+    if (hits == Hits::All) {
+      std::lock_guard lock(results_mutex);
+      for (size_t p = 0; p < patterns.size(); ++p) {
+        results[p].insert(results[p].end(), local[p].begin(), local[p].end());
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads; ++t) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (auto &thread : pool) {
+    thread.join();
+  }
+
+  for (size_t p = 0; p < patterns.size(); ++p) {
+    if (hits == Hits::First) {
+      if (first[p] != SIZE_MAX)
+        results[p].push_back(first[p]);
+    } else {
+      std::sort(results[p].begin(), results[p].end());
+    }
+  }
+  return results;
+}
+
+} // namespace scan
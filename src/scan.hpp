@@ -0,0 +1,337 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SCAN_TARGET_AVX2 __attribute__((target("avx2")))
+#define SCAN_TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#define SCAN_TARGET_AVX2
+#define SCAN_TARGET_SSE2
+#endif
+
+// Byte signature scanning. Patterns are IDA-style strings ("48 8B ? ? 89"), wildcards
+// are "?" or "??". Searches anchor on the rarest non-wildcard byte of the pattern with
+// wide compares (AVX2 when the CPU has it, SSE2 otherwise) and only verify the full
+// masked pattern at candidate positions. All paths return the same first match.
+//
+// Signatures known at build time should be written as "48 8B ? ? 89"_sig: they are
+// parsed at compile time, so a malformed one fails the build, and the scan runs without
+// any allocation with the pattern length as a constant.
+//
+// Plain C++ without Windows dependencies, so it can be built and checked anywhere.
+namespace scan {
+
+// Non-owning pattern, what the search kernels work on
+struct PatternView {
+  const uint8_t *bytes = nullptr;
+  const uint8_t *mask = nullptr; // 0xFF where the byte must match, 0 for wildcards
+  size_t size = 0;
+  size_t anchor = 0;             // Offsets of the two rarest masked bytes
+  size_t second = 0;
+
+  bool has_anchor() const { return size > 0 && mask[anchor] != 0; }
+};
+
+// Runtime-parsed pattern
+struct Pattern {
+  std::vector<uint8_t> bytes;
+  std::vector<uint8_t> mask;
+  size_t anchor = 0;
+  size_t second = 0;
+
+  size_t size() const { return bytes.size(); }
+  bool empty() const { return bytes.empty(); }
+  bool has_anchor() const { return view().has_anchor(); }
+  PatternView view() const { return {bytes.data(), mask.data(), bytes.size(), anchor, second}; }
+};
+
+// Compile-time parsed pattern of N bytes
+template<size_t N>
+struct FixedPattern {
+  std::array<uint8_t, N> bytes = {};
+  std::array<uint8_t, N> mask = {};
+  size_t anchor = 0;
+  size_t second = 0;
+
+  static constexpr size_t size() { return N; }
+  PatternView view() const { return {bytes.data(), mask.data(), N, anchor, second}; }
+};
+
+// String literal usable as a template argument
+template<size_t N>
+struct FixedString {
+  char chars[N] = {};
+
+  consteval FixedString(const char (&str)[N]) {
+    for (size_t i = 0; i < N; ++i) {
+      chars[i] = str[i];
+    }
+  }
+};
+
+namespace detail {
+
+// Rough frequency of bytes in x86 code, most common first. Anything not listed counts as
+// rare. Opcodes, ModRM bytes and small immediates dominate.
+inline constexpr uint8_t COMMON_BYTES[] = {
+    0x00, 0xFF, 0x8B, 0x48, 0x89, 0xCC, 0x0F, 0xE8, 0x24, 0x45, 0x01, 0x4C, 0x83, 0x85,
+    0x44, 0x08, 0x10, 0x74, 0x75, 0xC0, 0x04, 0x0C, 0x50, 0x8D, 0x40, 0x20, 0x18, 0x5D,
+    0xC3, 0x55, 0xEC, 0x33, 0x02, 0xE5, 0x84, 0x41, 0x80, 0x14, 0x03, 0xEB, 0x4D, 0xF8,
+    0xC7, 0x06, 0x90, 0x46, 0x56, 0xFC, 0x1C, 0x57, 0x28, 0x30, 0x38, 0x3B, 0x07, 0x05,
+};
+
+constexpr int rarity(uint8_t byte) {
+  constexpr int count = static_cast<int>(sizeof(COMMON_BYTES));
+  for (int i = 0; i < count; ++i) {
+    if (COMMON_BYTES[i] == byte)
+      return i + 1; // 1 for the most common byte
+  }
+  return count + 1;
+}
+
+// Rarest masked byte first, then the rarest one at another offset to halve candidates again
+constexpr void pick_anchors(const uint8_t *bytes, const uint8_t *mask, size_t size, size_t &anchor,
+                            size_t &second) {
+  int best = 0, second_best = 0;
+  anchor = second = 0;
+  for (size_t j = 0; j < size; ++j) {
+    if (!mask[j])
+      continue;
+    int score = (rarity(bytes[j]) << 8) | static_cast<int>(j < 255 ? j : 255);
+    if (score > best) {
+      second_best = best;
+      second = anchor;
+      best = score;
+      anchor = j;
+    } else if (score > second_best) {
+      second_best = score;
+      second = j;
+    }
+  }
+  if (second_best == 0)
+    second = anchor;
+}
+
+constexpr int hex_value(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+// Number of pattern bytes in str, fails constant evaluation on malformed input
+consteval size_t count_bytes(const char *str) {
+  size_t count = 0;
+  for (const char *p = str; *p; ++p) {
+    if (*p == ' ')
+      continue;
+    if (*p == '?') {
+      if (p[1] == '?') ++p;
+    } else if (hex_value(p[0]) < 0 || hex_value(p[1]) < 0) {
+      throw "signature: expected two hex digits or a wildcard";
+    } else {
+      ++p;
+    }
+    if (p[1] && p[1] != ' ')
+      throw "signature: bytes must be separated by spaces";
+    ++count;
+  }
+  if (count == 0)
+    throw "signature: empty pattern";
+  return count;
+}
+
+template<size_t N>
+consteval FixedPattern<N> parse_fixed(const char *str) {
+  FixedPattern<N> pattern;
+  size_t i = 0;
+  for (const char *p = str; *p; ++p) {
+    if (*p == ' ')
+      continue;
+    if (*p == '?') {
+      if (p[1] == '?') ++p;
+    } else {
+      pattern.bytes[i] = static_cast<uint8_t>(hex_value(p[0]) * 16 + hex_value(p[1]));
+      pattern.mask[i] = 0xFF;
+      ++p;
+    }
+    ++i;
+  }
+  pick_anchors(pattern.bytes.data(), pattern.mask.data(), N, pattern.anchor, pattern.second);
+  return pattern;
+}
+
+// N is the pattern length when known at compile time, 0 for runtime patterns
+template<size_t N>
+inline bool matches(const uint8_t *at, const PatternView &pattern) {
+  size_t size = N ? N : pattern.size;
+  for (size_t j = 0; j < size; ++j) {
+    if ((at[j] ^ pattern.bytes[j]) & pattern.mask[j])
+      return false;
+  }
+  return true;
+}
+
+// Candidates are positions i + bit where both anchors match, verify each in order
+template<size_t N>
+inline const uint8_t *check_candidates(const uint8_t *data, size_t i, uint32_t bits, const PatternView &pattern) {
+  while (bits) {
+    int bit = std::countr_zero(bits);
+    if (matches<N>(data + i + bit, pattern))
+      return data + i + bit;
+    bits &= bits - 1;
+  }
+  return nullptr;
+}
+
+template<size_t N>
+const uint8_t *find_scalar(const uint8_t *data, size_t size, const PatternView &pattern) {
+  if (pattern.size == 0 || size < pattern.size)
+    return nullptr;
+
+  size_t last = size - pattern.size;
+  if (!pattern.has_anchor())
+    return data;
+
+  uint8_t anchor = pattern.bytes[pattern.anchor];
+  for (size_t i = 0; i <= last; ++i) {
+    if (data[i + pattern.anchor] == anchor && matches<N>(data + i, pattern))
+      return data + i;
+  }
+  return nullptr;
+}
+
+#if SCAN_X86
+
+template<size_t N>
+SCAN_TARGET_SSE2 const uint8_t *find_sse2(const uint8_t *data, size_t size, const PatternView &pattern) {
+  if (pattern.size == 0 || size < pattern.size || !pattern.has_anchor())
+    return find_scalar<N>(data, size, pattern);
+
+  size_t count = size - pattern.size + 1; // Candidate start positions
+  const __m128i first = _mm_set1_epi8(static_cast<char>(pattern.bytes[pattern.anchor]));
+  const __m128i second = _mm_set1_epi8(static_cast<char>(pattern.bytes[pattern.second]));
+
+  // Loads at i + anchor stay in bounds while i + 16 <= count
+  size_t i = 0;
+  for (; i + 16 <= count; i += 16) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + pattern.anchor));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + pattern.second));
+    __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, second));
+    uint32_t bits = static_cast<uint32_t>(_mm_movemask_epi8(eq));
+    if (bits) {
+      if (auto found = check_candidates<N>(data, i, bits, pattern))
+        return found;
+    }
+  }
+
+  return find_scalar<N>(data + i, size - i, pattern);
+}
+
+template<size_t N>
+SCAN_TARGET_AVX2 const uint8_t *find_avx2(const uint8_t *data, size_t size, const PatternView &pattern) {
+  if (pattern.size == 0 || size < pattern.size || !pattern.has_anchor())
+    return find_scalar<N>(data, size, pattern);
+
+  size_t count = size - pattern.size + 1;
+  const __m256i first = _mm256_set1_epi8(static_cast<char>(pattern.bytes[pattern.anchor]));
+  const __m256i second = _mm256_set1_epi8(static_cast<char>(pattern.bytes[pattern.second]));
+
+  size_t i = 0;
+  for (; i + 32 <= count; i += 32) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + pattern.anchor));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + pattern.second));
+    __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, second));
+    uint32_t bits = static_cast<uint32_t>(_mm256_movemask_epi8(eq));
+    if (bits) {
+      if (auto found = check_candidates<N>(data, i, bits, pattern))
+        return found;
+    }
+  }
+
+  return find_sse2<N>(data + i, size - i, pattern);
+}
+
+#else
+
+template<size_t N>
+const uint8_t *find_sse2(const uint8_t *data, size_t size, const PatternView &pattern) {
+  return find_scalar<N>(data, size, pattern);
+}
+
+template<size_t N>
+const uint8_t *find_avx2(const uint8_t *data, size_t size, const PatternView &pattern) {
+  return find_scalar<N>(data, size, pattern);
+}
+
+#endif
+
+enum class Level { Scalar, SSE2, AVX2 };
+Level cpu_level();
+
+template<size_t N>
+const uint8_t *find(const uint8_t *data, size_t size, const PatternView &pattern) {
+  static const Level level = cpu_level();
+  switch (level) {
+  case Level::AVX2: return find_avx2<N>(data, size, pattern);
+  case Level::SSE2: return find_sse2<N>(data, size, pattern);
+  default: return find_scalar<N>(data, size, pattern);
+  }
+}
+
+} // namespace detail
+
+// Parses a signature at compile time, see also the _sig literal
+template<FixedString S>
+consteval auto pattern() {
+  constexpr size_t n = detail::count_bytes(S.chars);
+  return detail::parse_fixed<n>(S.chars);
+}
+
+namespace literals {
+
+template<FixedString S>
+consteval auto operator""_sig() {
+  return pattern<S>();
+}
+
+} // namespace literals
+
+Pattern parse(const char *pattern);
+
+// First match in [data, data + size), nullptr if there is none
+const uint8_t *find(const uint8_t *data, size_t size, const Pattern &pattern);
+
+template<size_t N>
+const uint8_t *find(const uint8_t *data, size_t size, const FixedPattern<N> &pattern) {
+  return detail::find<N>(data, size, pattern.view());
+}
+
+enum class Hits { First, All };
+
+// Resolves several patterns in one parallel pass. The range is split into cache-sized
+// chunks that worker threads claim in order; every pattern is searched in a chunk while it
+// is hot, and a match starting in a chunk is found even if it runs past the chunk's end.
+// Returns the match offsets of each pattern in ascending order, at most one with Hits::First.
+// threads = 0 picks one per hardware thread.
+std::vector<std::vector<size_t>> find_many(const uint8_t *data, size_t size, const std::vector<Pattern> &patterns,
+                                           Hits hits = Hits::All, unsigned threads = 0);
+
+// Individual paths, find() dispatches to the widest one the CPU supports
+const uint8_t *find_scalar(const uint8_t *data, size_t size, const Pattern &pattern);
+const uint8_t *find_sse2(const uint8_t *data, size_t size, const Pattern &pattern);
+const uint8_t *find_avx2(const uint8_t *data, size_t size, const Pattern &pattern);
+
+bool has_sse2();
+bool has_avx2();
+
+} // namespace scan
@@ -0,0 +1,165 @@
+#include "sig_cache.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr char MAGIC[8] = {'L', 'J', 'E', 'S', 'I', 'G', 'S', '1'};
+
+// Bytes of the code section hashed into the build identity: the end and a block every stride
+constexpr size_t SAMPLE_BLOCK = 4096;
+constexpr size_t SAMPLE_STRIDE = 1024 * 1024;
+
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ull;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+uint64_t fnv(uint64_t h, const void *data, size_t size) {
+  auto p = static_cast<const uint8_t *>(data);
+  for (size_t i = 0; i < size; ++i) {
+    h = (h ^ p[i]) * FNV_PRIME;
+  }
+  return h;
+}
+
+} // namespace
+
+SigCache::SigCache(std::string path)
+  : path_(std::move(path)) {}
+
+std::string SigCache::default_path() {
+  HMODULE self = nullptr;
+  GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                     reinterpret_cast<LPCSTR>(&SigCache::default_path), &self);
+
+  char path[MAX_PATH] = {};
+  DWORD len = GetModuleFileNameA(self, path, MAX_PATH);
+  std::string dir(path, len);
+  auto slash = dir.find_last_of("\\/");
+  dir = slash == std::string::npos ? std::string() : dir.substr(0, slash + 1);
+  return dir + "lje-imgui.sigcache";
+}
+
+uintptr_t SigCache::scan(const Module &module, const scan::Pattern &pattern) {
+  return scan(module, pattern.view(), [&] { return module.scan(pattern); });
+}
+
+bool SigCache::save() {
+  std::lock_guard lock(mutex_);
+  if (!dirty_)
+    return true;
+
+  // Write a temporary file and swap it in, so a crash never leaves a torn cache
+  std::string tmp = path_ + ".tmp";
+  FILE *f = fopen(tmp.c_str(), "wb");
+  if (!f)
+    return false;
+
+  uint32_t count = static_cast<uint32_t>(entries_.size());
+  bool ok = fwrite(MAGIC, sizeof(MAGIC), 1, f) == 1 && fwrite(&count, sizeof(count), 1, f) == 1;
+  if (ok && count > 0)
+    ok = fwrite(entries_.data(), sizeof(Entry), count, f) == count;
+  ok = fclose(f) == 0 && ok;
+
+  if (!ok || !MoveFileExA(tmp.c_str(), path_.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+    logger::warn("Failed to write signature cache %s", path_.c_str());
+    DeleteFileA(tmp.c_str());
+    return false;
+  }
+
+  dirty_ = false;
+  return true;
+}
+
+void SigCache::load() {
+  loaded_ = true;
+
+  FILE *f = fopen(path_.c_str(), "rb");
+  if (!f)
+    return;
+
+  char magic[sizeof(MAGIC)];
+  uint32_t count = 0;
+  if (fread(magic, sizeof(magic), 1, f) == 1 && memcmp(magic, MAGIC, sizeof(MAGIC)) == 0 &&
+      fread(&count, sizeof(count), 1, f) == 1) {
+    entries_.resize(count);
+    if (count > 0 && fread(entries_.data(), sizeof(Entry), count, f) != count) {
+      logger::warn("Signature cache %s is truncated, ignoring it", path_.c_str());
+      entries_.clear();
+    }
+  }
+  fclose(f);
+}
+
+const SigCache::ModuleInfo &SigCache::module_info(const Module &module) {
+  for (const auto &info : modules_) {
+    if (info.base == module.base())
+      return info;
+  }
+
+  ModuleInfo info;
+  info.base = module.base();
+
+  // Case-insensitive file name, the same DLL can be loaded from different paths
+  wchar_t path[MAX_PATH] = {};
+  DWORD len = GetModuleFileNameW(module.handle(), path, MAX_PATH);
+  const wchar_t *file = path;
+  for (DWORD i = 0; i < len; ++i) {
+    if (path[i] == L'\\' || path[i] == L'/')
+      file = path + i + 1;
+  }
+  info.name = FNV_OFFSET;
+  for (const wchar_t *c = file; *c; ++c) {
+    wchar_t lower = (*c >= L'A' && *c <= L'Z') ? static_cast<wchar_t>(*c - L'A' + L'a') : *c;
+    info.name = fnv(info.name, &lower, sizeof(lower));
+  }
+
+  // Build identity: link timestamp, image size and samples of the code section. The
+  // samples are read from the file, loaded code differs between runs once it is relocated.
+  uint64_t h = FNV_OFFSET;
+  uint32_t timestamp = module.timestamp();
+  uint64_t size = module.size();
+  h = fnv(h, &timestamp, sizeof(timestamp));
+  h = fnv(h, &size, sizeof(size));
+
+  HANDLE file_handle = len > 0 ? CreateFileW(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr)
+                               : INVALID_HANDLE_VALUE;
+  if (file_handle != INVALID_HANDLE_VALUE) {
+    uint8_t block[SAMPLE_BLOCK];
+    auto sample = [&](size_t offset, size_t count) {
+      LARGE_INTEGER at;
+      at.QuadPart = static_cast<LONGLONG>(module.code_file_offset() + offset);
+      DWORD read = 0;
+      if (SetFilePointerEx(file_handle, at, nullptr, FILE_BEGIN) &&
+          ReadFile(file_handle, block, static_cast<DWORD>(count), &read, nullptr))
+        h = fnv(h, block, read);
+    };
+
+    size_t code_size = module.code_file_size();
+    for (size_t offset = 0; offset < code_size; offset += SAMPLE_STRIDE) {
+      sample(offset, (std::min)(SAMPLE_BLOCK, code_size - offset));
+    }
+    size_t tail = (std::min)(SAMPLE_BLOCK, code_size);
+    if (tail > 0)
+      sample(code_size - tail, tail);
+    CloseHandle(file_handle);
+  }
+  info.identity = h;
+
+  // Another build of the module invalidates all of its entries
+  size_t before = entries_.size();
+  std::erase_if(entries_, [&](const Entry &e) { return e.module_name == info.name && e.identity != info.identity; });
+  dirty_ |= entries_.size() != before;
+
+  modules_.push_back(info);
+  return modules_.back();
+}
+
+uint64_t SigCache::pattern_hash(const scan::PatternView &pattern) {
+  uint64_t h = FNV_OFFSET;
+  h = fnv(h, pattern.bytes, pattern.size);
+  h = fnv(h, pattern.mask, pattern.size);
+  return h;
+}
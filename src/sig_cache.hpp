@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "module.hpp"
+#include "scan.hpp"
+
+// Signature scan results persisted across game starts as RVAs. Entries belong to a module
+// build, identified by its PE timestamp, SizeOfImage and a hash of blocks sampled from its
+// code section on disk. A cached RVA is still checked against the pattern's masked bytes
+// before use, and a failed check falls back to a full scan that updates the entry.
+class SigCache {
+public:
+  explicit SigCache(std::string path);
+
+  // Cache file next to this DLL, in the modules folder
+  static std::string default_path();
+
+  uintptr_t scan(const Module &module, const scan::Pattern &pattern);
+
+  template<size_t N>
+  uintptr_t scan(const Module &module, const scan::FixedPattern<N> &pattern) {
+    return scan(module, pattern.view(), [&] { return module.scan(pattern); });
+  }
+
+  // Writes the cache back if anything changed, returns false on I/O errors
+  bool save();
+
+private:
+  struct Entry {
+    uint64_t module_name = 0; // Hash of the module's file name
+    uint64_t identity = 0;    // Build of that module
+    uint64_t pattern = 0;     // Hash of the pattern's bytes and mask
+    uint32_t rva = 0;
+  };
+
+  template<typename Scan>
+  uintptr_t scan(const Module &module, const scan::PatternView &pattern, Scan &&full_scan);
+
+  struct ModuleInfo {
+    uintptr_t base = 0;
+    uint64_t name = 0;
+    uint64_t identity = 0;
+  };
+
+  void load();
+  // Identifies the module once and drops entries of its other builds, mutex_ held
+  const ModuleInfo &module_info(const Module &module);
+  static uint64_t pattern_hash(const scan::PatternView &pattern);
+
+  std::string path_;
+  std::mutex mutex_;
+  std::vector<Entry> entries_;
+  std::vector<ModuleInfo> modules_;
+  bool loaded_ = false;
+  bool dirty_ = false;
+};
+
+template<typename Scan>
+uintptr_t SigCache::scan(const Module &module, const scan::PatternView &pattern, Scan &&full_scan) {
+  uint64_t key = pattern_hash(pattern);
+
+  std::lock_guard lock(mutex_);
+  if (!loaded_)
+    load();
+
+  const ModuleInfo &info = module_info(module);
+  uint64_t name = info.name;
+  uint64_t identity = info.identity;
+
+  Entry *entry = nullptr;
+  for (auto &e : entries_) {
+    if (e.module_name == name && e.pattern == key) {
+      entry = &e;
+      break;
+    }
+  }
+
+  // O(pattern) check of the cached location
+  if (entry && pattern.size > 0 && pattern.size <= module.size() && entry->rva <= module.size() - pattern.size) {
+    auto at = reinterpret_cast<const uint8_t *>(module.base() + entry->rva);
+    if (scan::detail::matches<0>(at, pattern))
+      return module.base() + entry->rva;
+  }
+
+  uintptr_t found = full_scan();
+  if (found) {
+    if (!entry) {
+      entries_.push_back({name, identity, key, 0});
+      entry = &entries_.back();
+    }
+    entry->rva = static_cast<uint32_t>(found - module.base());
+    dirty_ = true;
+  } else if (entry) {
+    std::erase_if(entries_, [&](const Entry &e) { return &e == entry; });
+    dirty_ = true;
+  }
+  return found;
+}
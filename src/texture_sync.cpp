@@ -0,0 +1,267 @@
+#include "texture_sync.hpp"
+#include <cstring>
+
+namespace {
+
+// What ImGui resets UpdateRect to once a texture is up to date
+constexpr ImTextureRect EMPTY_RECT = {0xFFFF, 0xFFFF, 0, 0};
+
+// Copies rect out of tex as tightly packed RGBA32, Alpha8 is expanded to white
+unsigned char *copy_rect(ImTextureData *tex, const ImTextureRect &rect, unsigned char *dst) {
+  size_t row_bytes = static_cast<size_t>(rect.w) * 4;
+  for (int row = 0; row < rect.h; ++row, dst += row_bytes) {
+    auto src = static_cast<const unsigned char *>(tex->GetPixelsAt(rect.x, rect.y + row));
+    if (tex->Format == ImTextureFormat_RGBA32) {
+      memcpy(dst, src, row_bytes);
+      continue;
+    }
+    for (int i = 0; i < rect.w; ++i) {
+      dst[i * 4 + 0] = 0xFF;
+      dst[i * 4 + 1] = 0xFF;
+      dst[i * 4 + 2] = 0xFF;
+      dst[i * 4 + 3] = src[i];
+    }
+  }
+  return dst;
+}
+
+} // namespace
+
+TextureSync::~TextureSync() {
+  release();
+}
+
+void TextureSync::collect(const ImVector<ImTextureData *> *textures) {
+  apply_results();
+
+  // Unregistered user textures and atlas textures ImGui freed without waiting for us
+  for (auto &[proxy, state] : proxies_) {
+    if (state.live && !(textures && textures->contains(state.live))) {
+      proxy_of_.erase(state.live);
+      state.live = nullptr;
+    }
+    if (!state.live) {
+      state.destroying = true;
+      if (!state.in_flight)
+        request(proxy, state, ImTextureStatus_WantDestroy);
+    }
+  }
+
+  if (!textures)
+    return;
+
+  for (ImTextureData *tex : *textures) {
+    if (tex->Status == ImTextureStatus_OK || tex->Status == ImTextureStatus_Destroyed)
+      continue;
+
+    auto it = proxy_of_.find(tex);
+    if (tex->Status == ImTextureStatus_WantDestroy) {
+      // Same grace frame as the stock backends
+      if (tex->UnusedFrames == 0)
+        continue;
+      if (it == proxy_of_.end()) {
+        // Never went to the device
+        tex->SetTexID(ImTextureID_Invalid);
+        tex->SetStatus(ImTextureStatus_Destroyed);
+        continue;
+      }
+      Proxy &state = proxies_.at(it->second);
+      state.destroying = true;
+      if (!state.in_flight)
+        request(it->second, state, ImTextureStatus_WantDestroy);
+      continue;
+    }
+
+    if (it == proxy_of_.end()) {
+      it = proxy_of_.emplace(tex, IM_NEW(ImTextureData)()).first;
+      proxies_.emplace(it->second, Proxy{tex});
+    }
+    Proxy &state = proxies_.at(it->second);
+    if (state.in_flight || state.destroying)
+      continue;
+
+    bool update = state.created && tex->Status == ImTextureStatus_WantUpdates;
+    request(it->second, state, update ? ImTextureStatus_WantUpdates : ImTextureStatus_WantCreate);
+  }
+}
+
+void TextureSync::publish(DrawSnapshot &slot) {
+  auto &requests = slot.texture_requests();
+  if (slot.requests_applied()) {
+    for (auto &request : requests) {
+      if (pool_.size() < POOL_SIZE && request.pixels.capacity() <= POOL_MAX_BYTES)
+        pool_.push_back(std::move(request.pixels));
+    }
+    requests.clear();
+  }
+
+  // A slot the reader skipped still holds its requests, they go out with this frame
+  for (auto &request : requests_) {
+    requests.push_back(std::move(request));
+  }
+  requests_.clear();
+  slot.set_requests_applied(requests.empty());
+
+  for (ImDrawList *list : slot.data()->CmdLists) {
+    for (ImDrawCmd &cmd : list->CmdBuffer) {
+      if (!cmd.TexRef._TexData)
+        continue;
+      auto it = proxy_of_.find(cmd.TexRef._TexData);
+      if (it != proxy_of_.end() && !proxies_.at(it->second).destroying)
+        cmd.TexRef._TexData = it->second;
+      else
+        cmd.TexRef = ImTextureRef();
+    }
+  }
+}
+
+void TextureSync::complete(const std::vector<TextureRequest> &requests) {
+  std::lock_guard lock(mutex_);
+  for (const TextureRequest &request : requests) {
+    results_.push_back({request.proxy, request.status, request.applied ? Event::Applied : Event::Failed,
+                        request.tex_id});
+  }
+}
+
+void TextureSync::lost(const std::vector<ImTextureData *> &proxies) {
+  std::lock_guard lock(mutex_);
+  for (ImTextureData *proxy : proxies) {
+    results_.push_back({proxy, ImTextureStatus_OK, Event::Lost, ImTextureID_Invalid});
+  }
+}
+
+void TextureSync::release() {
+  for (auto &[proxy, state] : proxies_) {
+    IM_DELETE(proxy);
+  }
+  proxies_.clear();
+  proxy_of_.clear();
+  requests_.clear();
+  pool_.clear();
+  applying_.clear();
+
+  std::lock_guard lock(mutex_);
+  results_.clear();
+}
+
+void TextureSync::apply_results() {
+  {
+    std::lock_guard lock(mutex_);
+    applying_.swap(results_);
+  }
+
+  for (const Result &result : applying_) {
+    auto it = proxies_.find(result.proxy);
+    if (it == proxies_.end())
+      continue;
+    Proxy &state = it->second;
+    ImTextureData *tex = state.live;
+
+    if (result.event == Event::Lost) {
+      state.created = false;
+      state.uploaded_updates = 0;
+      if (tex && tex->Status != ImTextureStatus_WantDestroy) {
+        tex->SetTexID(ImTextureID_Invalid);
+        tex->SetStatus(ImTextureStatus_WantCreate);
+      }
+      continue;
+    }
+
+    // A failed request is retried by the next collect()
+    state.in_flight = false;
+    if (result.event == Event::Failed)
+      continue;
+
+    switch (result.status) {
+    case ImTextureStatus_WantCreate:
+      state.created = true;
+      if (tex) {
+        tex->SetTexID(result.tex_id);
+        // Anything written since the copy shows up in UpdateRect, uploading it all again is rare enough
+        if (tex->Status == ImTextureStatus_WantCreate && tex->UpdateRect.w == 0)
+          tex->SetStatus(ImTextureStatus_OK);
+      }
+      break;
+    case ImTextureStatus_WantUpdates:
+      state.uploaded_updates = state.copied_updates;
+      if (tex && tex->Status == ImTextureStatus_WantUpdates && tex->Updates.Size == state.uploaded_updates) {
+        tex->SetStatus(ImTextureStatus_OK);
+        state.uploaded_updates = 0;
+      }
+      break;
+    case ImTextureStatus_WantDestroy:
+      if (tex) {
+        tex->SetTexID(ImTextureID_Invalid);
+        tex->SetStatus(ImTextureStatus_Destroyed);
+      }
+      forget(result.proxy);
+      break;
+    default:
+      break;
+    }
+  }
+  applying_.clear();
+}
+
+void TextureSync::request(ImTextureData *proxy, Proxy &state, ImTextureStatus status) {
+  ImTextureData *tex = state.live;
+  TextureRequest request;
+  request.proxy = proxy;
+  request.status = status;
+
+  if (status == ImTextureStatus_WantCreate) {
+    request.width = tex->Width;
+    request.height = tex->Height;
+    request.pixels = take_buffer(static_cast<size_t>(tex->Width) * tex->Height * 4);
+    copy_rect(tex, {0, 0, static_cast<unsigned short>(tex->Width), static_cast<unsigned short>(tex->Height)},
+              request.pixels.data());
+
+    // Everything queued so far is in the copy
+    tex->Updates.resize(0);
+    tex->UpdateRect = EMPTY_RECT;
+    state.uploaded_updates = 0;
+    state.copied_updates = 0;
+  } else if (status == ImTextureStatus_WantUpdates) {
+    if (state.uploaded_updates == tex->Updates.Size) {
+      tex->SetStatus(ImTextureStatus_OK);
+      state.uploaded_updates = 0;
+      return;
+    }
+
+    size_t bytes = 0;
+    for (int i = state.uploaded_updates; i < tex->Updates.Size; ++i) {
+      bytes += static_cast<size_t>(tex->Updates[i].w) * tex->Updates[i].h * 4;
+    }
+
+    request.width = tex->Width;
+    request.height = tex->Height;
+    request.pixels = take_buffer(bytes);
+    unsigned char *dst = request.pixels.data();
+    for (int i = state.uploaded_updates; i < tex->Updates.Size; ++i) {
+      request.rects.push_back(tex->Updates[i]);
+      dst = copy_rect(tex, tex->Updates[i], dst);
+    }
+    state.copied_updates = tex->Updates.Size;
+  }
+
+  state.in_flight = true;
+  requests_.push_back(std::move(request));
+}
+
+std::vector<unsigned char> TextureSync::take_buffer(size_t size) {
+  std::vector<unsigned char> buffer;
+  if (!pool_.empty()) {
+    buffer = std::move(pool_.back());
+    pool_.pop_back();
+  }
+  buffer.resize(size);
+  return buffer;
+}
+
+void TextureSync::forget(ImTextureData *proxy) {
+  auto it = proxies_.find(proxy);
+  if (it->second.live)
+    proxy_of_.erase(it->second.live);
+  proxies_.erase(it);
+  IM_DELETE(proxy);
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <imgui.h>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "draw_snapshot.hpp"
+
+// Keeps the device copies of ImGui's textures, the font atlas and user textures, in step
+// with the live ImTextureData. Those belong to the Lua thread: ImGui bakes glyphs into the
+// atlas and drops textures in the middle of a frame, so the render thread never sees them.
+//
+// Each live texture that goes to the device gets a proxy, an ImTextureData whose TexID the
+// render thread owns. After ImGui::Render, collect() copies the pending work of every
+// texture into TextureRequests, and publish() moves them into the frame's snapshot and
+// points its draw commands at the proxies. The render thread reports back through
+// complete() and lost(), and the next collect() writes Status and TexID back to the live
+// textures.
+//
+// A proxy is only freed once the render thread has applied its destroy request, which
+// travels in a frame whose commands no longer reference it.
+class TextureSync {
+public:
+  TextureSync() = default;
+  ~TextureSync();
+
+  TextureSync(const TextureSync &) = delete;
+  TextureSync &operator=(const TextureSync &) = delete;
+
+  // Lua thread, after ImGui::Render, with the frame's texture list
+  void collect(const ImVector<ImTextureData *> *textures);
+
+  // Requests collected but not published yet, the frame has to be published to deliver them
+  bool has_requests() const { return !requests_.empty(); }
+
+  // Lua thread, on the slot about to be published
+  void publish(DrawSnapshot &slot);
+
+  // Render thread: results of update_textures(), and proxies released by a device reset
+  void complete(const std::vector<TextureRequest> &requests);
+  void lost(const std::vector<ImTextureData *> &proxies);
+
+  // Frees the proxies, after the renderer has shut down
+  void release();
+
+private:
+  struct Proxy {
+    ImTextureData *live;     // Null once ImGui has dropped the texture
+    bool in_flight = false;  // One request at a time, the next one waits for its result
+    bool created = false;    // Has a device texture
+    bool destroying = false; // Draw commands no longer reference it
+    int uploaded_updates = 0; // Entries of live->Updates already on the device
+    int copied_updates = 0;   // Entries of live->Updates in the request in flight
+  };
+
+  enum class Event { Applied, Failed, Lost };
+
+  struct Result {
+    ImTextureData *proxy;
+    ImTextureStatus status;
+    Event event;
+    ImTextureID tex_id;
+  };
+
+  // Pixel buffers kept for reuse, larger ones are dropped once applied
+  static constexpr size_t POOL_SIZE = 8;
+  static constexpr size_t POOL_MAX_BYTES = 1024 * 1024;
+
+  void apply_results();
+  void request(ImTextureData *proxy, Proxy &state, ImTextureStatus status);
+  std::vector<unsigned char> take_buffer(size_t size);
+  void forget(ImTextureData *proxy);
+
+  // Lua thread
+  std::unordered_map<ImTextureData *, ImTextureData *> proxy_of_; // Live texture to proxy
+  std::unordered_map<ImTextureData *, Proxy> proxies_;
+  std::vector<TextureRequest> requests_;
+  std::vector<std::vector<unsigned char>> pool_;
+  std::vector<Result> applying_;
+
+  // Shared with the render thread
+  std::mutex mutex_;
+  std::vector<Result> results_;
+};
@@ -0,0 +1,156 @@
+#include "user_textures.hpp"
+#include <imgui_internal.h>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr int MAX_TEXTURE_SIZE = 4096;
+
+int source_bpp(UserTextures::Format format) {
+  return format == UserTextures::Format::Alpha8 ? 1 : 4;
+}
+
+// Grows the pending update rect, TextureSync copies the listed rects out on the next frame
+void queue_update(ImTextureData *tex, const ImTextureRect &rect) {
+  // Once TextureSync has caught up, previous updates were uploaded
+  if (tex->Status == ImTextureStatus_OK) {
+    tex->Updates.resize(0);
+    tex->UpdateRect = {};
+  }
+
+  if (tex->Updates.Size == 0) {
+    tex->UpdateRect = rect;
+  } else {
+    int x0 = std::min<int>(tex->UpdateRect.x, rect.x);
+    int y0 = std::min<int>(tex->UpdateRect.y, rect.y);
+    int x1 = std::max<int>(tex->UpdateRect.x + tex->UpdateRect.w, rect.x + rect.w);
+    int y1 = std::max<int>(tex->UpdateRect.y + tex->UpdateRect.h, rect.y + rect.h);
+    tex->UpdateRect = {static_cast<unsigned short>(x0), static_cast<unsigned short>(y0),
+                       static_cast<unsigned short>(x1 - x0), static_cast<unsigned short>(y1 - y0)};
+  }
+  tex->Updates.push_back(rect);
+
+  // A texture that is still waiting to be created uploads all of its pixels anyway
+  if (tex->Status == ImTextureStatus_OK)
+    tex->SetStatus(ImTextureStatus_WantUpdates);
+}
+
+} // namespace
+
+UserTextures::~UserTextures() {
+  release();
+}
+
+ImTextureData *UserTextures::create(int width, int height, Format format) {
+  if (width <= 0 || height <= 0 || width > MAX_TEXTURE_SIZE || height > MAX_TEXTURE_SIZE)
+    return nullptr;
+
+  auto tex = IM_NEW(ImTextureData)();
+  tex->Create(ImTextureFormat_RGBA32, width, height);
+  tex->UniqueID = next_unique_id_--;
+  memset(tex->Pixels, 0, static_cast<size_t>(tex->GetSizeInBytes()));
+  ImGui::RegisterUserTexture(tex);
+
+  entries_.push_back({tex, format});
+  return tex;
+}
+
+bool UserTextures::update(ImTextureData *tex, const void *data, size_t size, int x, int y, int w, int h) {
+  Entry *entry = find(tex);
+  if (!entry || !data)
+    return false;
+
+  // Bounded first, so the clamping below can't overflow
+  if (w <= 0 || h <= 0 || w > MAX_TEXTURE_SIZE || h > MAX_TEXTURE_SIZE || x < -w || y < -h || x > tex->Width ||
+      y > tex->Height)
+    return false;
+
+  // Clamp to the texture, the source stride stays the requested width
+  int bpp = source_bpp(entry->format);
+  size_t src_stride = static_cast<size_t>(w) * bpp;
+  int skip_x = std::max(0, -x);
+  int skip_y = std::max(0, -y);
+  int x0 = std::max(0, x), y0 = std::max(0, y);
+  int x1 = std::min(tex->Width, x + w), y1 = std::min(tex->Height, y + h);
+  if (x1 <= x0 || y1 <= y0)
+    return false;
+  if (size < src_stride * static_cast<size_t>(h))
+    return false;
+
+  int copy_w = x1 - x0, copy_h = y1 - y0;
+  size_t row_bytes = static_cast<size_t>(copy_w) * 4;
+
+  auto src = static_cast<const unsigned char *>(data);
+  for (int row = 0; row < copy_h; ++row) {
+    const unsigned char *from =
+      src + static_cast<size_t>(row + skip_y) * src_stride + static_cast<size_t>(skip_x) * bpp;
+    auto to = static_cast<unsigned char *>(tex->GetPixelsAt(x0, y0 + row));
+    if (entry->format == Format::RGBA32) {
+      memcpy(to, from, row_bytes);
+    } else {
+      for (int i = 0; i < copy_w; ++i) {
+        to[i * 4 + 0] = 0xFF;
+        to[i * 4 + 1] = 0xFF;
+        to[i * 4 + 2] = 0xFF;
+        to[i * 4 + 3] = from[i];
+      }
+    }
+  }
+
+  queue_update(tex, {static_cast<unsigned short>(x0), static_cast<unsigned short>(y0),
+                     static_cast<unsigned short>(copy_w), static_cast<unsigned short>(copy_h)});
+  return true;
+}
+
+void UserTextures::destroy(ImTextureData *tex) {
+  auto it = std::find_if(entries_.begin(), entries_.end(), [tex](const Entry &entry) { return entry.tex == tex; });
+  if (it == entries_.end())
+    return;
+
+  ImGui::UnregisterUserTexture(tex);
+  destroyed_.push_back(tex);
+  entries_.erase(it);
+}
+
+bool UserTextures::contains(ImTextureData *tex) const {
+  return find(tex) != nullptr;
+}
+
+UserTextures::Format UserTextures::format(ImTextureData *tex) const {
+  const Entry *entry = find(tex);
+  return entry ? entry->format : Format::RGBA32;
+}
+
+void UserTextures::new_frame() {
+  for (ImTextureData *tex : destroyed_)
+    IM_DELETE(tex);
+  destroyed_.clear();
+}
+
+void UserTextures::release() {
+  // The renderer's shutdown already released the device copies
+  for (auto &entry : entries_) {
+    if (ImGui::GetCurrentContext())
+      ImGui::UnregisterUserTexture(entry.tex);
+    IM_DELETE(entry.tex);
+  }
+  entries_.clear();
+  new_frame();
+}
+
+UserTextures::Entry *UserTextures::find(ImTextureData *tex) {
+  for (auto &entry : entries_) {
+    if (entry.tex == tex)
+      return &entry;
+  }
+  return nullptr;
+}
+
+const UserTextures::Entry *UserTextures::find(ImTextureData *tex) const {
+  for (const auto &entry : entries_) {
+    if (entry.tex == tex)
+      return &entry;
+  }
+  return nullptr;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <imgui.h>
+#include <cstddef>
+#include <vector>
+
+// Textures created and streamed from Lua. Each one is an ImTextureData registered with
+// the context, so TextureSync hands it to the renderer with the same requests it builds
+// for the font atlas: only the rect that changed is uploaded, and Lua never touches the
+// device.
+//
+// Lua thread only. The render thread never sees these ImTextureData, just the copies
+// TextureSync puts in the published frame.
+//
+// Pixels are kept as RGBA32; Alpha8 sources are expanded to white on update.
+class UserTextures {
+public:
+  enum class Format { RGBA32, Alpha8 };
+
+  UserTextures() = default;
+  ~UserTextures();
+
+  UserTextures(const UserTextures &) = delete;
+  UserTextures &operator=(const UserTextures &) = delete;
+
+  ImTextureData *create(int width, int height, Format format);
+
+  // Copies a w*h block of source pixels, tightly packed in the texture's format, into the
+  // rect at x, y. The rect is clamped to the texture, and must overlap it.
+  bool update(ImTextureData *tex, const void *data, size_t size, int x, int y, int w, int h);
+
+  // Unregisters the texture right away, TextureSync releases its device copy once the
+  // texture is no longer listed. The memory is freed on the next frame.
+  void destroy(ImTextureData *tex);
+
+  bool contains(ImTextureData *tex) const;
+  Format format(ImTextureData *tex) const;
+
+  // Frees textures destroyed during the previous frame
+  void new_frame();
+
+  void release();
+
+private:
+  struct Entry {
+    ImTextureData *tex;
+    Format format;
+  };
+
+  Entry *find(ImTextureData *tex);
+  const Entry *find(ImTextureData *tex) const;
+
+  std::vector<Entry> entries_;
+  int next_unique_id_ = -1; // Counts down, clear of the ids the font atlas hands out
+  // Unregistered, but draw lists of the frame that destroyed them may still point at them
+  std::vector<ImTextureData *> destroyed_;
+};
@@ -0,0 +1,221 @@
+#include "window_cache.hpp"
+#include <imgui_internal.h>
+
+namespace {
+
+constexpr int EVICT_AFTER_FRAMES = 600;
+constexpr uint64_t UNTRACKED_LIST = ~0ull;
+
+bool same(const ImVec2 &a, const ImVec2 &b) {
+  return a.x == b.x && a.y == b.y;
+}
+
+bool is_focused(ImGuiWindow *root) {
+  ImGuiContext &g = *GImGui;
+  return g.NavWindow && g.NavWindow->RootWindow == root;
+}
+
+// While the mouse is over the window or one of its items is active, hover and press
+// states can change its geometry without the content version changing
+bool is_interacting(ImGuiWindow *root) {
+  ImGuiContext &g = *GImGui;
+  auto in_root = [root](ImGuiWindow *w) { return w && w->RootWindow == root; };
+  return in_root(g.HoveredWindow) || in_root(g.ActiveIdWindow) || in_root(g.MovingWindow);
+}
+
+int atlas_id() {
+  ImTextureData *tex = ImGui::GetIO().Fonts->TexData;
+  return tex ? tex->UniqueID : 0;
+}
+
+} // namespace
+
+bool WindowCache::begin_window(ImGuiWindow *window, double version) {
+  // Child windows are cached as part of their root window
+  if (!window || window->RootWindow != window)
+    return false;
+
+  ImGuiContext &g = *GImGui;
+  if (frame_ != g.FrameCount) {
+    frame_windows_.clear();
+    frame_ = g.FrameCount;
+  }
+
+  // Appending to a window that was already begun this frame keeps the first decision
+  for (const auto &fw : frame_windows_) {
+    if (fw.window == window)
+      return fw.use == Use::Reused;
+  }
+
+  auto &slot = entries_[window->ID];
+  if (!slot)
+    slot = std::make_unique<Entry>();
+  Entry *entry = slot.get();
+  entry->last_used_frame = g.FrameCount;
+
+  // Lists pointing at a texture that is gone are dropped, not just skipped this frame
+  if (entry->generation > 0 && (entry->atlas_id != atlas_id() || !textures_alive(*entry))) {
+    entry->lists.release();
+    entry->textures.clear();
+    entry->generation = 0;
+  }
+
+  bool reusable = entry->generation > 0 && entry->version == version &&
+                  same(entry->pos, window->Pos) && same(entry->size, window->Size) &&
+                  same(entry->scroll, window->Scroll) && entry->focused == is_focused(window) &&
+                  !is_interacting(window);
+
+  frame_windows_.push_back({window, entry, reusable ? Use::Reused : Use::Rebuilt, false});
+  if (!reusable) {
+    entry->version = version;
+    return false;
+  }
+
+  // Reserve the same content extents, so scrollbars and auto-resize see the same window
+  ImGui::Dummy(entry->content_size);
+  return true;
+}
+
+bool WindowCache::capture(const ImDrawData *draw_data, DrawSnapshot &out, bool force) {
+  ImGuiContext &g = *GImGui;
+
+  if (!draw_data || !draw_data->Valid || frame_ != g.FrameCount) {
+    frame_windows_.clear();
+    last_signature_.clear();
+    out.capture(draw_data);
+    return true;
+  }
+
+  // Resolve which of this frame's cached windows each list belongs to
+  owners_.clear();
+  bool all_reused = true;
+  for (const ImDrawList *list : draw_data->CmdLists) {
+    FrameWindow *owner = nullptr;
+    for (ImGuiWindow *w : g.Windows) {
+      if (!w->Active || w->DrawList != list)
+        continue;
+      for (auto &fw : frame_windows_) {
+        if (fw.window == w->RootWindow) {
+          owner = &fw;
+          break;
+        }
+      }
+      break;
+    }
+    owners_.push_back(owner);
+    if (!owner || owner->use != Use::Reused)
+      all_reused = false;
+  }
+
+  // Whole-frame reuse: same cached windows in the same order as the last captured frame
+  if (all_reused && !force && same(draw_data->DisplaySize, last_display_size_)) {
+    signature_.clear();
+    for (auto *owner : owners_) {
+      if (!owner->seen) {
+        owner->seen = true;
+        signature_.push_back((static_cast<uint64_t>(owner->window->ID) << 32) |
+                             owner->entry->generation);
+      }
+    }
+    if (signature_ == last_signature_) {
+      frame_windows_.clear();
+      sweep(g.FrameCount);
+      return false;
+    }
+    for (auto &fw : frame_windows_) {
+      fw.seen = false;
+    }
+  }
+
+  out.begin(draw_data);
+  signature_.clear();
+  for (int i = 0; i < draw_data->CmdListsCount; ++i) {
+    const ImDrawList *list = draw_data->CmdLists[i];
+    FrameWindow *owner = owners_[i];
+
+    if (!owner) {
+      out.add(list);
+      signature_.push_back(UNTRACKED_LIST);
+      continue;
+    }
+
+    Entry *entry = owner->entry;
+    if (!owner->seen) {
+      owner->seen = true;
+      if (owner->use == Use::Rebuilt) {
+        ImGuiWindow *window = owner->window;
+        entry->lists.begin(nullptr);
+        entry->pos = window->Pos;
+        entry->size = window->Size;
+        entry->scroll = window->Scroll;
+        entry->content_size = ImVec2(window->DC.CursorMaxPos.x - window->DC.CursorStartPos.x,
+                                     window->DC.CursorMaxPos.y - window->DC.CursorStartPos.y);
+        entry->focused = is_focused(window);
+        entry->atlas_id = atlas_id();
+        entry->textures.clear();
+        entry->generation++;
+      } else {
+        out.add(entry->lists);
+      }
+      signature_.push_back((static_cast<uint64_t>(owner->window->ID) << 32) | entry->generation);
+    }
+
+    if (owner->use == Use::Rebuilt) {
+      out.add(list);
+      entry->lists.add(list);
+      add_textures(*entry, list);
+    }
+  }
+
+  last_signature_.swap(signature_);
+  last_display_size_ = draw_data->DisplaySize;
+  frame_windows_.clear();
+  sweep(g.FrameCount);
+  return true;
+}
+
+void WindowCache::release() {
+  entries_.clear();
+  frame_windows_.clear();
+  owners_.clear();
+  signature_.clear();
+  last_signature_.clear();
+}
+
+// Only entries still in the context's texture list are dereferenced, a destroyed user
+// texture may already be freed
+bool WindowCache::textures_alive(const Entry &entry) {
+  const auto &live = ImGui::GetPlatformIO().Textures;
+  for (const TextureUse &use : entry.textures) {
+    if (!live.contains(use.tex) || use.tex->UniqueID != use.unique_id ||
+        use.tex->Status == ImTextureStatus_WantDestroy || use.tex->Status == ImTextureStatus_Destroyed)
+      return false;
+  }
+  return true;
+}
+
+void WindowCache::add_textures(Entry &entry, const ImDrawList *list) {
+  for (const ImDrawCmd &cmd : list->CmdBuffer) {
+    ImTextureData *tex = cmd.TexRef._TexData;
+    if (!tex)
+      continue;
+    bool known = false;
+    for (const TextureUse &use : entry.textures) {
+      known = known || use.tex == tex;
+    }
+    if (!known)
+      entry.textures.push_back({tex, tex->UniqueID});
+  }
+}
+
+void WindowCache::sweep(int frame) {
+  if (frame % 60 != 0)
+    return;
+
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (frame - it->second->last_used_frame > EVICT_AFTER_FRAMES)
+      it = entries_.erase(it);
+    else
+      ++it;
+  }
+}
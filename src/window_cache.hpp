@@ -0,0 +1,71 @@
+#pragma once
+#include <imgui.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "draw_snapshot.hpp"
+
+struct ImGuiWindow;
+
+// Opt-in reuse of window geometry between frames. A window begun with a content version
+// keeps a copy of its draw lists; while the version, placement and focus stay the same
+// and the mouse is not interacting with it, Lua can skip building its contents and the
+// cached lists are stitched into the frame instead.
+class WindowCache {
+public:
+  // Called right after ImGui::Begin. Returns true if the caller should skip emitting the
+  // window's contents because its cached lists will be used.
+  bool begin_window(ImGuiWindow *window, double version);
+
+  // Copies the finished frame into out, substituting cached windows. Returns false when
+  // every list came from the cache unchanged since the last captured frame, in which case
+  // out is left untouched and the previous frame can simply be drawn again. force always
+  // fills out, for frames that have to be published anyway.
+  bool capture(const ImDrawData *draw_data, DrawSnapshot &out, bool force = false);
+
+  void release();
+
+private:
+  struct TextureUse {
+    ImTextureData *tex;
+    int unique_id; // Tells a new texture at the same address apart
+  };
+
+  struct Entry {
+    double version = 0.0;
+    ImVec2 pos;
+    ImVec2 size;
+    ImVec2 scroll;
+    ImVec2 content_size;
+    bool focused = false;
+    uint32_t generation = 0; // Bumped every time the lists are recaptured
+    int last_used_frame = 0;
+    DrawSnapshot lists;
+
+    // The lists bake in UVs of the font atlas texture they were built against and point at
+    // the textures they use, either going away makes them unusable
+    int atlas_id = 0;
+    std::vector<TextureUse> textures;
+  };
+
+  enum class Use { Reused, Rebuilt };
+
+  struct FrameWindow {
+    ImGuiWindow *window;
+    Entry *entry;
+    Use use;
+    bool seen;
+  };
+
+  static bool textures_alive(const Entry &entry);
+  static void add_textures(Entry &entry, const ImDrawList *list);
+  void sweep(int frame);
+
+  std::unordered_map<ImGuiID, std::unique_ptr<Entry>> entries_;
+  std::vector<FrameWindow> frame_windows_;
+  std::vector<FrameWindow *> owners_;
+  int frame_ = -1;
+  std::vector<uint64_t> signature_;
+  std::vector<uint64_t> last_signature_;
+  ImVec2 last_display_size_;
+};
@@ -0,0 +1,154 @@
+#include "api/binding.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+LjeApi *g_api = nullptr;
+
+// ns/call for the most common widget signatures, the old hand-written style (gettop, read,
+// pop the arguments, push) against bind<>. The mock stack is slower than Lua's, so compare
+// the columns rather than the absolute numbers; setting up the arguments is subtracted.
+namespace {
+
+using binding::bind;
+using binding::Opt;
+using binding::Str;
+using Clock = std::chrono::steady_clock;
+
+volatile float sink_f;
+volatile size_t sink_n;
+
+bool button(const char *label, Opt<float> w, Opt<float> h) {
+  sink_f = w + h;
+  return label[0] == 'x';
+}
+
+int button_hand(lua_State *L) {
+  auto lua = g_api->lua;
+  const char *label = lua->tolstring(L, 1, nullptr);
+  float w = 0, h = 0;
+  int nargs = lua->gettop(L);
+  if (nargs >= 2)
+    w = static_cast<float>(lua->tonumber(L, 2));
+  if (nargs >= 3)
+    h = static_cast<float>(lua->tonumber(L, 3));
+  lua->pop(L, nargs);
+  lua->pushboolean(L, button(label ? label : "", {w}, {h}));
+  return 1;
+}
+
+std::tuple<bool, bool> checkbox(const char *label, bool value) {
+  return {label[0] == 'x', !value};
+}
+
+int checkbox_hand(lua_State *L) {
+  auto lua = g_api->lua;
+  const char *label = lua->tolstring(L, 1, nullptr);
+  bool value = lua->toboolean(L, 2);
+  lua->pop(L, 2);
+  auto [changed, result] = checkbox(label ? label : "", value);
+  lua->pushboolean(L, changed);
+  lua->pushboolean(L, result);
+  return 2;
+}
+
+std::tuple<bool, float> slider_float(const char *label, float value, float min, float max) {
+  return {label[0] == 'x', value < min ? min : value > max ? max : value};
+}
+
+int slider_float_hand(lua_State *L) {
+  auto lua = g_api->lua;
+  const char *label = lua->tolstring(L, 1, nullptr);
+  float value = static_cast<float>(lua->tonumber(L, 2));
+  float min = static_cast<float>(lua->tonumber(L, 3));
+  float max = static_cast<float>(lua->tonumber(L, 4));
+  lua->pop(L, 4);
+  auto [changed, result] = slider_float(label ? label : "", value, min, max);
+  lua->pushboolean(L, changed);
+  lua->pushnumber(L, result);
+  return 2;
+}
+
+void same_line(Opt<float> offset, Opt<float, -1.0f> spacing_w) {
+  sink_f = offset + spacing_w;
+}
+
+int same_line_hand(lua_State *L) {
+  auto lua = g_api->lua;
+  float offset = 0.0f, spacing_w = -1.0f;
+  int nargs = lua->gettop(L);
+  if (nargs >= 1)
+    offset = static_cast<float>(lua->tonumber(L, 1));
+  if (nargs >= 2)
+    spacing_w = static_cast<float>(lua->tonumber(L, 2));
+  lua->pop(L, nargs);
+  same_line({offset}, {spacing_w});
+  return 0;
+}
+
+void text(Str str) {
+  sink_n = str.len;
+}
+
+int text_hand(lua_State *L) {
+  auto lua = g_api->lua;
+  size_t len = 0;
+  const char *str = lua->tolstring(L, 1, &len);
+  lua->pop(L, 1);
+  text(str ? Str{str, len} : Str{"", 0});
+  return 0;
+}
+
+// Best of a few runs, ns per call including the argument setup
+double ns_per_call(int (*fn)(lua_State *), const std::vector<lua_State::Value> &args, int calls) {
+  lua_State L;
+  L.stack.reserve(16);
+  double best = 1e30;
+  for (int r = 0; r < 5; ++r) {
+    auto start = Clock::now();
+    for (int i = 0; i < calls; ++i) {
+      L.stack.assign(args.begin(), args.end());
+      if (fn)
+        fn(&L);
+    }
+    double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / calls;
+    best = ns < best ? ns : best;
+  }
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int calls = argc > 1 ? atoi(argv[1]) : 2000000;
+  g_api = new LjeApi{&mock_lua::table};
+
+  using mock_lua::boolean;
+  using mock_lua::num;
+  using mock_lua::str;
+
+  struct Case {
+    const char *name;
+    int (*hand)(lua_State *);
+    int (*bound)(lua_State *);
+    std::vector<lua_State::Value> args;
+  };
+  const Case cases[] = {
+    {"text(s)", text_hand, bind<text>, {str("Hello, world")}},
+    {"button(s)", button_hand, bind<button>, {str("Apply")}},
+    {"button(s, w, h)", button_hand, bind<button>, {str("Apply"), num(120), num(24)}},
+    {"checkbox(s, b)", checkbox_hand, bind<checkbox>, {str("Enabled"), boolean(true)}},
+    {"slider_float(s, f, f, f)", slider_float_hand, bind<slider_float>, {str("Alpha"), num(0.5), num(0), num(1)}},
+    {"same_line()", same_line_hand, bind<same_line>, {}},
+  };
+
+  printf("%-26s %10s %10s\n", "signature", "hand ns", "bind ns");
+  for (const Case &c : cases) {
+    double setup = ns_per_call(nullptr, c.args, calls);
+    double hand = ns_per_call(c.hand, c.args, calls) - setup;
+    double bound = ns_per_call(c.bound, c.args, calls) - setup;
+    printf("%-26s %10.2f %10.2f\n", c.name, hand, bound);
+  }
+  return 0;
+}
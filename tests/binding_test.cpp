@@ -0,0 +1,169 @@
+#include "api/binding.hpp"
+#include "check.hpp"
+#include <cstring>
+#include <string>
+
+LjeApi *g_api = nullptr;
+
+using binding::bind;
+using binding::Opt;
+using binding::Str;
+using mock_lua::boolean;
+using mock_lua::cdata;
+using mock_lua::lightuserdata;
+using mock_lua::nil;
+using mock_lua::num;
+using mock_lua::str;
+
+namespace {
+
+// Stand-ins with the signatures of the real widgets, they record what they were called with
+struct Seen {
+  std::string label;
+  float f[4] = {};
+  int i = 0;
+  bool b = false;
+  bool label_null = false;
+  size_t len = 0;
+} seen;
+
+void text(Str s) {
+  seen.label.assign(s.data, s.len);
+  seen.len = s.len;
+}
+
+bool button(const char *label, Opt<float> w, Opt<float> h) {
+  seen.label = label;
+  seen.f[0] = w;
+  seen.f[1] = h;
+  return label[0] == 'x';
+}
+
+std::tuple<bool, float> slider_float(const char *label, float value, float min, float max) {
+  seen.label = label;
+  return {true, value < min ? min : value > max ? max : value};
+}
+
+std::tuple<bool, int> drag_int(const char *label, int value, Opt<float, 1.0f> speed, Opt<int> min, Opt<int> max) {
+  seen.label = label;
+  seen.f[0] = speed;
+  seen.i = min + max;
+  return {false, value};
+}
+
+void same_line(Opt<float> offset, Opt<float, -1.0f> spacing_w) {
+  seen.f[0] = offset;
+  seen.f[1] = spacing_w;
+}
+
+bool selectable(const char *label, Opt<bool> selected) {
+  seen.label = label;
+  return selected;
+}
+
+void progress_bar(float fraction, Opt<float, -1.0f> w, Opt<float> h, Opt<const char *> overlay) {
+  seen.f[0] = fraction;
+  seen.f[1] = w;
+  seen.f[2] = h;
+  seen.label_null = overlay.value == nullptr;
+}
+
+bool open_flag(Opt<bool, true> open) {
+  return open;
+}
+
+// Calls fn with args on a fresh stack, returns the stack it leaves behind
+template<auto Fn>
+lua_State call(std::initializer_list<lua_State::Value> args, int expect_results) {
+  lua_State L;
+  L.stack = args;
+  size_t nargs = L.stack.size();
+  seen = {};
+  int results = bind<Fn>(&L);
+  CHECK(results == expect_results);
+  CHECK(L.stack.size() == nargs + results); // Results are pushed above the arguments
+  L.stack.erase(L.stack.begin(), L.stack.begin() + nargs);
+  return L;
+}
+
+void check_args() {
+  // Required strings read nil and missing as ""
+  call<button>({nil()}, 1);
+  CHECK(seen.label.empty());
+  call<button>({}, 1);
+  CHECK(seen.label.empty());
+
+  // Missing optionals take their defaults
+  auto r = call<button>({str("xy")}, 1);
+  CHECK(seen.label == "xy" && seen.f[0] == 0.0f && seen.f[1] == 0.0f);
+  CHECK(r.stack[0].type == 1 && r.stack[0].boolean);
+  call<button>({str("ab"), num(10), num(20)}, 1);
+  CHECK(seen.f[0] == 10.0f && seen.f[1] == 20.0f);
+
+  // Non-zero defaults: nil and missing use them, an explicit 0 does not
+  call<same_line>({}, 0);
+  CHECK(seen.f[0] == 0.0f && seen.f[1] == -1.0f);
+  call<same_line>({num(5), num(0)}, 0);
+  CHECK(seen.f[0] == 5.0f && seen.f[1] == 0.0f);
+  call<same_line>({nil(), nil()}, 0);
+  CHECK(seen.f[1] == -1.0f);
+
+  call<drag_int>({str("d"), num(3)}, 2);
+  CHECK(seen.f[0] == 1.0f && seen.i == 0);
+  call<drag_int>({str("d"), num(3), num(0), num(-5), num(9)}, 2);
+  CHECK(seen.f[0] == 0.0f && seen.i == 4);
+
+  call<progress_bar>({num(0.5)}, 0);
+  CHECK(seen.f[0] == 0.5f && seen.f[1] == -1.0f && seen.f[2] == 0.0f && seen.label_null);
+  call<progress_bar>({num(0.5), num(100), num(8), str("50%")}, 0);
+  CHECK(seen.f[1] == 100.0f && seen.f[2] == 8.0f && !seen.label_null);
+
+  // Booleans: false by default, or true when the default says so and the value is nil
+  CHECK(!call<selectable>({str("s")}, 1).stack[0].boolean);
+  CHECK(call<selectable>({str("s"), boolean(true)}, 1).stack[0].boolean);
+  CHECK(call<open_flag>({}, 1).stack[0].boolean);
+  CHECK(call<open_flag>({nil()}, 1).stack[0].boolean);
+  CHECK(!call<open_flag>({boolean(false)}, 1).stack[0].boolean);
+
+  // Str keeps the Lua length, embedded NULs included
+  lua_State::Value embedded = str("");
+  embedded.string.assign("a\0b", 3);
+  call<text>({embedded}, 0);
+  CHECK(seen.len == 3 && seen.label.size() == 3 && seen.label[2] == 'b');
+  call<text>({nil()}, 0);
+  CHECK(seen.len == 0);
+}
+
+void check_results() {
+  auto r = call<slider_float>({str("f"), num(7), num(0), num(5)}, 2);
+  CHECK(r.stack[0].type == 1 && r.stack[0].boolean);
+  CHECK(r.stack[1].type == 3 && r.stack[1].number == 5.0);
+
+  r = call<drag_int>({str("i"), num(42)}, 2);
+  CHECK(r.stack[0].type == 1 && !r.stack[0].boolean);
+  CHECK(r.stack[1].type == 3 && r.stack[1].number == 42.0);
+}
+
+// Buffers for imgui.submit, text_lines and update_texture: light userdata and FFI arrays
+void check_pointers() {
+  double buffer[4] = {};
+  lua_State L;
+  L.stack = {lightuserdata(buffer), cdata(buffer), str("abc"), num(1), nil(), lightuserdata(nullptr)};
+  CHECK(binding::to_pointer(&L, 1) == buffer);
+  CHECK(binding::to_pointer(&L, 2) == buffer);
+  CHECK(binding::to_pointer(&L, 3) == nullptr); // Strings are read with their length instead
+  CHECK(binding::to_pointer(&L, 4) == nullptr);
+  CHECK(binding::to_pointer(&L, 5) == nullptr);
+  CHECK(binding::to_pointer(&L, 6) == nullptr);
+  CHECK(binding::to_pointer(&L, 7) == nullptr); // Past the top
+}
+
+} // namespace
+
+int main() {
+  g_api = new LjeApi{&mock_lua::table};
+  check_args();
+  check_results();
+  check_pointers();
+  return 0;
+}
@@ -0,0 +1,94 @@
+#include "render/dx9_state.hpp"
+#include "check.hpp"
+
+namespace {
+
+// Every state the overlay changes, as recorded by record_setup_states
+constexpr int SETUP_RENDER_STATES = 21;
+constexpr int SETUP_TEXTURE_STAGE_STATES = 9;
+constexpr int SETUP_SAMPLER_STATES = 5;
+constexpr int SETUP_TRANSFORMS = 2;
+
+void check_create() {
+  IDirect3DDevice9 dev;
+  Dx9RenderState state;
+  CHECK(!state.ready());
+  CHECK(state.create(&dev, 0x142));
+  CHECK(state.ready());
+
+  const MockCalls &c = dev.calls;
+  CHECK(c.begin_state_block == 2 && c.end_state_block == 2);
+
+  // The saved block records setup and per-frame states, the setup block only the former
+  CHECK(c.render_state == 2 * SETUP_RENDER_STATES);
+  CHECK(c.texture_stage_state == 2 * SETUP_TEXTURE_STAGE_STATES);
+  CHECK(c.sampler_state == 2 * SETUP_SAMPLER_STATES);
+  CHECK(c.transform == 2 * SETUP_TRANSFORMS + 1);
+  CHECK(c.pixel_shader == 2 && c.vertex_shader == 2 && c.fvf == 2);
+  CHECK(c.viewport == 1 && c.stream_source == 1 && c.indices == 1 && c.texture == 1 && c.scissor_rect == 1);
+
+  // Recording never changes the game's state
+  CHECK(c.applied_to_device == 0);
+
+  state.release();
+  CHECK(!state.ready() && c.release == 2);
+}
+
+// A frame costs three state block calls and nothing else, however many frames are drawn
+void check_frames() {
+  IDirect3DDevice9 dev;
+  Dx9RenderState state;
+  CHECK(state.create(&dev, 0x142));
+  MockCalls before = dev.calls;
+
+  constexpr int FRAMES = 1000;
+  for (int i = 0; i < FRAMES; ++i) {
+    state.save();
+    state.apply_setup();
+    state.restore();
+  }
+
+  const MockCalls &c = dev.calls;
+  CHECK(c.capture == FRAMES);
+  CHECK(c.apply == 2 * FRAMES);
+  CHECK(c.begin_state_block == before.begin_state_block && c.end_state_block == before.end_state_block);
+  CHECK(c.render_state == before.render_state && c.texture_stage_state == before.texture_stage_state);
+  CHECK(c.sampler_state == before.sampler_state && c.transform == before.transform);
+  CHECK(c.applied_to_device == 0);
+  CHECK(c.release == 0);
+}
+
+// Recreated after a device reset: the old blocks are released first
+void check_recreate() {
+  IDirect3DDevice9 dev;
+  Dx9RenderState state;
+  CHECK(state.create(&dev, 0x142));
+  CHECK(state.create(&dev, 0x142));
+  CHECK(dev.calls.release == 2);
+  CHECK(dev.calls.begin_state_block == 4);
+  state.release();
+  CHECK(dev.calls.release == 4);
+}
+
+// A failed recording leaves nothing behind
+void check_failure() {
+  for (int fail = 1; fail <= 2; ++fail) {
+    IDirect3DDevice9 dev;
+    dev.fail_end_state_block = fail;
+    Dx9RenderState state;
+    CHECK(!state.create(&dev, 0x142));
+    CHECK(!state.ready());
+    CHECK(dev.calls.release == fail - 1); // The saved block is released if the setup one fails
+    CHECK(!dev.recording);
+  }
+}
+
+} // namespace
+
+int main() {
+  check_create();
+  check_frames();
+  check_recreate();
+  check_failure();
+  return 0;
+}
@@ -0,0 +1,148 @@
+#include "input_recorder.hpp"
+#include "log.hpp"
+#include "check.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// The logger's writer is Windows-only, messages are filtered out before they reach it
+namespace logger::detail {
+std::atomic<int> min_level = 4;
+Slot *claim() {
+  return nullptr;
+}
+void publish(Slot *, Level) {}
+} // namespace logger::detail
+
+namespace {
+
+const std::string PATH = "input_recorder_test.ljeinput";
+
+InputEvent key(uint16_t key, bool down, uint8_t mods) {
+  InputEvent event = {};
+  event.type = InputEvent::Type::Key;
+  event.key = key;
+  event.down = down;
+  event.mods = mods;
+  event.vk = 0x41;
+  event.scancode = 30;
+  return event;
+}
+
+InputEvent mouse_pos(float x, float y) {
+  InputEvent event = {};
+  event.type = InputEvent::Type::MousePos;
+  event.source = 1;
+  event.x = x;
+  event.y = y;
+  return event;
+}
+
+bool same(const InputEvent &a, const InputEvent &b) {
+  return a.type == b.type && a.source == b.source && a.mods == b.mods && a.down == b.down && a.key == b.key &&
+         a.vk == b.vk && a.scancode == b.scancode && a.x == b.x && a.y == b.y;
+}
+
+std::vector<unsigned char> read_file() {
+  std::vector<unsigned char> bytes;
+  FILE *f = fopen(PATH.c_str(), "rb");
+  CHECK(f);
+  int c;
+  while ((c = fgetc(f)) != EOF)
+    bytes.push_back(static_cast<unsigned char>(c));
+  fclose(f);
+  return bytes;
+}
+
+void write_file(const std::vector<unsigned char> &bytes) {
+  FILE *f = fopen(PATH.c_str(), "wb");
+  CHECK(f);
+  CHECK(fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size());
+  fclose(f);
+}
+
+const std::vector<std::vector<InputEvent>> FRAMES = {
+  {mouse_pos(10.0f, 20.0f)},
+  {},
+  {key(546, true, InputEvent::MOD_CTRL | InputEvent::MOD_SHIFT), mouse_pos(-1.5f, 3.25f), key(546, false, 0)},
+};
+
+void record() {
+  InputRecorder recorder;
+  CHECK(recorder.start_recording(PATH));
+  for (size_t i = 0; i < FRAMES.size(); ++i) {
+    recorder.record(FRAMES[i], 0.016f, 1280.0f, 720.0f + i);
+  }
+  CHECK(recorder.frame() == FRAMES.size());
+  recorder.stop();
+}
+
+// Events come back with their modifiers, frames with their timing and display size
+void check_round_trip() {
+  record();
+
+  InputRecorder recorder;
+  CHECK(recorder.start_replay(PATH));
+  CHECK(recorder.frame_count() == FRAMES.size());
+
+  std::vector<InputEvent> events = {mouse_pos(0.0f, 0.0f)}; // Live input is replaced
+  InputRecorder::Frame frame;
+  for (size_t i = 0; i < FRAMES.size(); ++i) {
+    CHECK(recorder.next_frame(events, frame));
+    CHECK(frame.number == i);
+    CHECK(frame.delta_time == 0.016f);
+    CHECK(frame.width == 1280.0f && frame.height == 720.0f + i);
+    CHECK(events.size() == FRAMES[i].size());
+    for (size_t e = 0; e < events.size(); ++e) {
+      CHECK(same(events[e], FRAMES[i][e]));
+    }
+  }
+
+  CHECK(!recorder.next_frame(events, frame));
+  CHECK(events.empty());
+  CHECK(recorder.mode() == InputRecorder::Mode::Idle);
+}
+
+// A frame whose number is out of sequence ends the replay there
+void check_frame_numbers() {
+  record();
+  std::vector<unsigned char> bytes = read_file();
+
+  // Second frame header follows the magic, the first header and its single 20 byte event
+  size_t second = 8 + 20 + 20;
+  bytes[second] = 7;
+  write_file(bytes);
+
+  InputRecorder recorder;
+  CHECK(recorder.start_replay(PATH));
+  std::vector<InputEvent> events;
+  InputRecorder::Frame frame;
+  CHECK(recorder.next_frame(events, frame));
+  CHECK(!recorder.next_frame(events, frame));
+  CHECK(recorder.mode() == InputRecorder::Mode::Idle);
+}
+
+// A recording cut short replays its complete frames
+void check_truncated() {
+  record();
+  std::vector<unsigned char> bytes = read_file();
+  bytes.resize(bytes.size() - 5);
+  write_file(bytes);
+
+  InputRecorder recorder;
+  CHECK(recorder.start_replay(PATH));
+  CHECK(recorder.frame_count() == FRAMES.size() - 1);
+
+  write_file({'L', 'J', 'E', 'I', 'N', 'P', 'T', '1'});
+  CHECK(!recorder.start_replay(PATH));
+}
+
+} // namespace
+
+int main() {
+  check_round_trip();
+  check_frame_numbers();
+  check_truncated();
+  remove(PATH.c_str());
+  return 0;
+}
@@ -0,0 +1,176 @@
+#pragma once
+// Just enough of d3d9.h to build src/render/dx9_state.cpp off Windows. The device counts
+// every call, so tests can check what the state blocks record and what a frame costs.
+#include <cstdint>
+
+using DWORD = uint32_t;
+using UINT = unsigned int;
+using HRESULT = long;
+using BOOL = int;
+
+#define FALSE 0
+#define TRUE 1
+#define D3D_OK 0
+
+struct RECT {
+  long left, top, right, bottom;
+};
+
+// Same brace layout as the real one, a union led by the 16 named elements
+struct D3DMATRIX {
+  union {
+    struct {
+      float e[16];
+    } elements;
+    float m[4][4];
+  };
+};
+
+struct D3DVIEWPORT9 {
+  DWORD X, Y, Width, Height;
+  float MinZ, MaxZ;
+};
+
+enum D3DRENDERSTATETYPE {
+  D3DRS_ZENABLE = 7,
+  D3DRS_FILLMODE = 8,
+  D3DRS_SHADEMODE = 9,
+  D3DRS_ZWRITEENABLE = 14,
+  D3DRS_ALPHATESTENABLE = 15,
+  D3DRS_SRCBLEND = 19,
+  D3DRS_DESTBLEND = 20,
+  D3DRS_CULLMODE = 22,
+  D3DRS_ALPHABLENDENABLE = 27,
+  D3DRS_FOGENABLE = 28,
+  D3DRS_SPECULARENABLE = 29,
+  D3DRS_RANGEFOGENABLE = 48,
+  D3DRS_STENCILENABLE = 52,
+  D3DRS_CLIPPING = 136,
+  D3DRS_LIGHTING = 137,
+  D3DRS_SCISSORTESTENABLE = 174,
+  D3DRS_SRGBWRITEENABLE = 194,
+  D3DRS_SEPARATEALPHABLENDENABLE = 206,
+  D3DRS_SRCBLENDALPHA = 207,
+  D3DRS_DESTBLENDALPHA = 208,
+  D3DRS_BLENDOP = 171,
+};
+
+enum { D3DFILL_SOLID = 3 };
+enum { D3DSHADE_GOURAUD = 2 };
+enum { D3DCULL_NONE = 1 };
+enum { D3DBLENDOP_ADD = 1 };
+enum { D3DBLEND_ONE = 2, D3DBLEND_SRCALPHA = 5, D3DBLEND_INVSRCALPHA = 6 };
+
+enum D3DTEXTURESTAGESTATETYPE {
+  D3DTSS_COLOROP = 1,
+  D3DTSS_COLORARG1 = 2,
+  D3DTSS_COLORARG2 = 3,
+  D3DTSS_ALPHAOP = 4,
+  D3DTSS_ALPHAARG1 = 5,
+  D3DTSS_ALPHAARG2 = 6,
+  D3DTSS_TEXCOORDINDEX = 11,
+};
+
+enum { D3DTOP_DISABLE = 1, D3DTOP_MODULATE = 4 };
+enum { D3DTA_DIFFUSE = 0, D3DTA_TEXTURE = 2 };
+
+enum D3DSAMPLERSTATETYPE {
+  D3DSAMP_ADDRESSU = 1,
+  D3DSAMP_ADDRESSV = 2,
+  D3DSAMP_MAGFILTER = 5,
+  D3DSAMP_MINFILTER = 6,
+  D3DSAMP_SRGBTEXTURE = 11,
+};
+
+enum { D3DTEXF_LINEAR = 2 };
+enum { D3DTADDRESS_CLAMP = 3 };
+
+enum D3DTRANSFORMSTATETYPE { D3DTS_VIEW = 2, D3DTS_PROJECTION = 3, D3DTS_WORLD = 256 };
+
+struct IDirect3DPixelShader9;
+struct IDirect3DVertexShader9;
+struct IDirect3DVertexBuffer9;
+struct IDirect3DIndexBuffer9;
+struct IDirect3DBaseTexture9;
+
+struct MockCalls {
+  int begin_state_block = 0;
+  int end_state_block = 0;
+  int capture = 0;
+  int apply = 0;
+  int release = 0;
+  int pixel_shader = 0;
+  int vertex_shader = 0;
+  int fvf = 0;
+  int render_state = 0;
+  int texture_stage_state = 0;
+  int sampler_state = 0;
+  int transform = 0;
+  int viewport = 0;
+  int stream_source = 0;
+  int indices = 0;
+  int texture = 0;
+  int scissor_rect = 0;
+
+  // Set* calls that reached the device outside a state block recording
+  int applied_to_device = 0;
+};
+
+struct IDirect3DStateBlock9 {
+  MockCalls *calls;
+
+  HRESULT Capture() {
+    calls->capture++;
+    return D3D_OK;
+  }
+  HRESULT Apply() {
+    calls->apply++;
+    return D3D_OK;
+  }
+  UINT Release() {
+    calls->release++;
+    delete this;
+    return 0;
+  }
+};
+
+struct IDirect3DDevice9 {
+  MockCalls calls;
+  bool recording = false;
+  int fail_end_state_block = 0; // Number of the EndStateBlock call to fail, from 1
+
+  HRESULT BeginStateBlock() {
+    calls.begin_state_block++;
+    recording = true;
+    return D3D_OK;
+  }
+  HRESULT EndStateBlock(IDirect3DStateBlock9 **block) {
+    calls.end_state_block++;
+    recording = false;
+    if (calls.end_state_block == fail_end_state_block)
+      return -1;
+    *block = new IDirect3DStateBlock9{&calls};
+    return D3D_OK;
+  }
+
+  HRESULT SetPixelShader(IDirect3DPixelShader9 *) { return set(calls.pixel_shader); }
+  HRESULT SetVertexShader(IDirect3DVertexShader9 *) { return set(calls.vertex_shader); }
+  HRESULT SetFVF(DWORD) { return set(calls.fvf); }
+  HRESULT SetRenderState(D3DRENDERSTATETYPE, DWORD) { return set(calls.render_state); }
+  HRESULT SetTextureStageState(DWORD, D3DTEXTURESTAGESTATETYPE, DWORD) { return set(calls.texture_stage_state); }
+  HRESULT SetSamplerState(DWORD, D3DSAMPLERSTATETYPE, DWORD) { return set(calls.sampler_state); }
+  HRESULT SetTransform(D3DTRANSFORMSTATETYPE, const D3DMATRIX *) { return set(calls.transform); }
+  HRESULT SetViewport(const D3DVIEWPORT9 *) { return set(calls.viewport); }
+  HRESULT SetStreamSource(UINT, IDirect3DVertexBuffer9 *, UINT, UINT) { return set(calls.stream_source); }
+  HRESULT SetIndices(IDirect3DIndexBuffer9 *) { return set(calls.indices); }
+  HRESULT SetTexture(DWORD, IDirect3DBaseTexture9 *) { return set(calls.texture); }
+  HRESULT SetScissorRect(const RECT *) { return set(calls.scissor_rect); }
+
+private:
+  HRESULT set(int &count) {
+    count++;
+    if (!recording)
+      calls.applied_to_device++;
+    return D3D_OK;
+  }
+};
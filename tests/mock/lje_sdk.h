@@ -0,0 +1,149 @@
+#pragma once
+// Just enough of the LJE SDK to run bindings off the game: g_api->lua is a table of function
+// pointers over a plain value stack, with the same 1-based indexing and nil past the top.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct lua_State {
+  struct Value {
+    // LUA_TNIL, LUA_TBOOLEAN = 1, LUA_TLIGHTUSERDATA = 2, LUA_TNUMBER = 3, LUA_TSTRING = 4, LUA_TCDATA = 10
+    int type = 0;
+    double number = 0.0;
+    void *pointer = nullptr; // Light userdata, or the payload of a cdata
+    bool boolean = false;
+    std::string string;
+  };
+  std::vector<Value> stack;
+
+  const Value *at(int idx) const {
+    if (idx < 0)
+      idx += static_cast<int>(stack.size()) + 1;
+    return idx >= 1 && idx <= static_cast<int>(stack.size()) ? &stack[idx - 1] : nullptr;
+  }
+};
+
+struct LjeLua {
+  int (*gettop)(lua_State *L);
+  void (*pop)(lua_State *L, int n);
+  int (*type)(lua_State *L, int idx);
+  double (*tonumber)(lua_State *L, int idx);
+  int (*toboolean)(lua_State *L, int idx);
+  const char *(*tolstring)(lua_State *L, int idx, size_t *len);
+  void (*pushnumber)(lua_State *L, double n);
+  void (*pushboolean)(lua_State *L, int b);
+  void (*pushstring)(lua_State *L, const char *s);
+  void *(*tolightuserdata)(lua_State *L, int idx);
+  const void *(*topointer)(lua_State *L, int idx);
+};
+
+struct LjeApi {
+  LjeLua *lua;
+};
+
+// Implementations of the table above, for tests to install into their g_api
+namespace mock_lua {
+
+inline int gettop(lua_State *L) {
+  return static_cast<int>(L->stack.size());
+}
+
+inline void pop(lua_State *L, int n) {
+  L->stack.resize(L->stack.size() - static_cast<size_t>(n));
+}
+
+inline int type(lua_State *L, int idx) {
+  const lua_State::Value *v = L->at(idx);
+  return v ? v->type : -1; // LUA_TNONE
+}
+
+inline double tonumber(lua_State *L, int idx) {
+  const lua_State::Value *v = L->at(idx);
+  return v && v->type == 3 ? v->number : 0.0;
+}
+
+inline int toboolean(lua_State *L, int idx) {
+  const lua_State::Value *v = L->at(idx);
+  return v && (v->type == 1 ? v->boolean : v->type != 0);
+}
+
+inline const char *tolstring(lua_State *L, int idx, size_t *len) {
+  const lua_State::Value *v = L->at(idx);
+  if (!v || v->type != 4)
+    return nullptr;
+  if (len)
+    *len = v->string.size();
+  return v->string.c_str();
+}
+
+inline lua_State::Value nil() {
+  return {};
+}
+
+inline lua_State::Value boolean(bool b) {
+  lua_State::Value v;
+  v.type = 1;
+  v.boolean = b;
+  return v;
+}
+
+inline lua_State::Value num(double n) {
+  lua_State::Value v;
+  v.type = 3;
+  v.number = n;
+  return v;
+}
+
+inline lua_State::Value lightuserdata(void *p) {
+  lua_State::Value v;
+  v.type = 2;
+  v.pointer = p;
+  return v;
+}
+
+// LuaJIT cdata array, topointer gives the address of its elements
+inline lua_State::Value cdata(void *p) {
+  lua_State::Value v;
+  v.type = 10;
+  v.pointer = p;
+  return v;
+}
+
+inline lua_State::Value str(const char *s) {
+  lua_State::Value v;
+  v.type = 4;
+  v.string = s;
+  return v;
+}
+
+inline void pushnumber(lua_State *L, double n) {
+  L->stack.push_back(num(n));
+}
+
+inline void pushboolean(lua_State *L, int b) {
+  L->stack.push_back(boolean(b != 0));
+}
+
+inline void pushstring(lua_State *L, const char *s) {
+  L->stack.push_back(s ? str(s) : nil());
+}
+
+inline void *tolightuserdata(lua_State *L, int idx) {
+  const lua_State::Value *v = L->at(idx);
+  return v && v->type == 2 ? v->pointer : nullptr;
+}
+
+inline const void *topointer(lua_State *L, int idx) {
+  const lua_State::Value *v = L->at(idx);
+  if (!v)
+    return nullptr;
+  if (v->type == 4)
+    return v->string.c_str();
+  return v->type == 2 || v->type == 10 ? v->pointer : nullptr;
+}
+
+inline LjeLua table = {gettop,    pop,        type,        tonumber,        toboolean,
+                       tolstring, pushnumber, pushboolean, pushstring, tolightuserdata,
+                       topointer};
+
+} // namespace mock_lua
@@ -0,0 +1,155 @@
+#include "draw_optimizer.hpp"
+#include "draw_snapshot.hpp"
+#include "render/null_renderer.hpp"
+#include "texture_sync.hpp"
+#include "user_textures.hpp"
+#include "window_cache.hpp"
+#include <imgui_internal.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Per-frame cost of the frame pipeline with the headless renderer: the Lua-thread half of
+// Overlay::new_frame/render, then the render-thread half of render_draw_data, in one thread
+// and the same order. The UI stands in for a script: versioned windows of text and widgets,
+// a few rebuilt every frame, and a user texture streamed one row at a time.
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int WINDOWS = 16;
+constexpr int ROWS = 40;
+constexpr int TEXTURE_SIZE = 64;
+
+enum Phase { Build, Capture, Draw, PHASE_COUNT };
+const char *PHASE_NAMES[PHASE_COUNT] = {"build", "capture", "draw"};
+
+double ms_since(Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void build_ui(WindowCache &window_cache, ImTextureData *tex, int frame, int dirty) {
+  char label[64];
+  for (int w = 0; w < WINDOWS; ++w) {
+    snprintf(label, sizeof(label), "Window %d", w);
+    ImGui::SetNextWindowPos(ImVec2(20.0f + (w % 4) * 300.0f, 20.0f + (w / 4) * 250.0f), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(280.0f, 230.0f), ImGuiCond_Always);
+    bool visible = ImGui::Begin(label);
+
+    // The first dirty windows change every frame, the rest keep their version
+    double version = w < dirty ? static_cast<double>(frame) : 0.0;
+    if (visible && !window_cache.begin_window(ImGui::GetCurrentWindow(), version)) {
+      for (int row = 0; row < ROWS; ++row) {
+        ImGui::Text("Row %d: %d", row, w < dirty ? frame + row : row);
+        if (row % 8 == 0) {
+          ImGui::SameLine();
+          ImGui::SmallButton("x");
+        }
+      }
+      if (w == 0)
+        ImGui::Image(tex->GetTexRef(), ImVec2(TEXTURE_SIZE, TEXTURE_SIZE));
+    }
+    ImGui::End();
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  int frames = argc > 1 ? atoi(argv[1]) : 1000;
+  int dirty = argc > 2 ? atoi(argv[2]) : 2;
+  bool optimize = argc > 3 ? atoi(argv[3]) != 0 : true;
+  if (frames <= 0)
+    frames = 1000;
+
+  ImGui::CreateContext();
+  auto &io = ImGui::GetIO();
+  io.IniFilename = nullptr;
+  io.DisplaySize = ImVec2(1920.0f, 1080.0f);
+  io.DeltaTime = 1.0f / 60.0f;
+
+  NullRenderer renderer;
+  renderer.init();
+
+  UserTextures user_textures;
+  WindowCache window_cache;
+  DrawOptimizer draw_optimizer;
+  TextureSync texture_sync;
+  SnapshotBuffer snapshots;
+
+  ImTextureData *tex = user_textures.create(TEXTURE_SIZE, TEXTURE_SIZE, UserTextures::Format::RGBA32);
+  std::vector<uint32_t> row(TEXTURE_SIZE);
+
+  double phase_ms[PHASE_COUNT] = {};
+  uint64_t published = 0;
+
+  for (int frame = 0; frame < frames; ++frame) {
+    // Lua thread: Overlay::new_frame, the script, Overlay::render
+    auto start = Clock::now();
+    user_textures.new_frame();
+    ImGui::NewFrame();
+    for (int x = 0; x < TEXTURE_SIZE; ++x)
+      row[x] = 0xFF000000u | static_cast<uint32_t>(frame * 2654435761u + x);
+    user_textures.update(tex, row.data(), row.size() * sizeof(uint32_t), 0, frame % TEXTURE_SIZE, TEXTURE_SIZE, 1);
+    build_ui(window_cache, tex, frame, dirty);
+    ImGui::EndFrame();
+    ImGui::Render();
+    phase_ms[Build] += ms_since(start);
+
+    start = Clock::now();
+    ImDrawData *draw_data = ImGui::GetDrawData();
+    texture_sync.collect(draw_data->Textures);
+    auto &write_slot = snapshots.write_slot();
+    bool has_requests = texture_sync.has_requests() || !write_slot.requests_applied();
+    if (window_cache.capture(draw_data, write_slot, has_requests)) {
+      if (optimize)
+        draw_optimizer.run(write_slot);
+      texture_sync.publish(write_slot);
+      snapshots.publish();
+      ++published;
+    }
+    phase_ms[Capture] += ms_since(start);
+
+    // Render thread: Overlay::render_draw_data, replaying the last frame when nothing new came
+    start = Clock::now();
+    bool fresh = snapshots.acquire();
+    auto &read_slot = snapshots.read_slot();
+    if (fresh && !read_slot.requests_applied()) {
+      renderer.update_textures(read_slot.texture_requests());
+      texture_sync.complete(read_slot.texture_requests());
+      read_slot.set_requests_applied(true);
+    }
+    if (read_slot.data()->Valid)
+      renderer.render(read_slot.data());
+    phase_ms[Draw] += ms_since(start);
+  }
+
+  printf("%d frames, %d of %d windows rebuilt per frame, optimizer %s, %llu frames published\n\n", frames, dirty,
+         WINDOWS, optimize ? "on" : "off", static_cast<unsigned long long>(published));
+  printf("%-10s %12s\n", "phase", "us/frame");
+  for (int p = 0; p < PHASE_COUNT; ++p)
+    printf("%-10s %12.2f\n", PHASE_NAMES[p], phase_ms[p] * 1000.0 / frames);
+
+  const NullRenderer::Stats &totals = renderer.totals();
+  double drawn = totals.frames > 0 ? static_cast<double>(totals.frames) : 1.0;
+  printf("\nnull renderer, per frame drawn: %.1f draw calls, %.0f vertices, %.0f indices, %.1f callbacks\n",
+         totals.draw_calls / drawn, totals.vertices / drawn, totals.indices / drawn, totals.callbacks / drawn);
+  printf("textures: %llu creates, %llu updates, %llu bytes\n", static_cast<unsigned long long>(totals.texture_creates),
+         static_cast<unsigned long long>(totals.texture_updates),
+         static_cast<unsigned long long>(totals.texture_bytes));
+
+  Renderer::FrameStats stats = renderer.frame_stats();
+  printf("last frame stats: %u draw calls, %u state calls, %u locks, %u bytes uploaded, %u buffer creates\n",
+         stats.draw_calls, stats.state_calls, stats.locks, stats.bytes_uploaded, stats.buffer_creates);
+
+  // Same order as Overlay's shutdown: device first, then the proxies and the snapshots
+  renderer.shutdown();
+  texture_sync.release();
+  snapshots.release();
+  window_cache.release();
+  draw_optimizer.release();
+  user_textures.release();
+  ImGui::DestroyContext();
+  return 0;
+}
@@ -0,0 +1,109 @@
+#include "render/ring_allocator.hpp"
+#include "check.hpp"
+#include <random>
+#include <vector>
+
+namespace {
+
+// Stands in for a dynamic D3D buffer: remembers which frame wrote each element, so a
+// NOOVERWRITE lock over data a recent frame still uses is caught
+struct FakeBuffer {
+  std::vector<int> written_by;
+  int creates = 0;
+  int discards = 0;
+  int appends = 0;
+
+  void create(uint32_t capacity) {
+    written_by.assign(capacity, -1);
+    creates++;
+  }
+
+  void lock(RingAllocator::Span span, uint32_t count, int frame) {
+    CHECK(span.offset + count <= written_by.size());
+    if (span.discard) {
+      // The driver hands out fresh memory, nothing in flight is touched
+      written_by.assign(written_by.size(), -1);
+      discards++;
+    } else {
+      for (uint32_t i = span.offset; i < span.offset + count; ++i) {
+        CHECK(written_by[i] < 0 || frame - written_by[i] >= static_cast<int>(RingAllocator::FRAMES_PER_RING));
+      }
+      appends++;
+    }
+    for (uint32_t i = span.offset; i < span.offset + count; ++i) {
+      written_by[i] = frame;
+    }
+  }
+};
+
+// Same sequence as Dx9Renderer::reserve_buffers and upload
+void render(RingAllocator &ring, FakeBuffer &buffer, uint32_t count, int frame) {
+  if (buffer.written_by.empty() || !ring.fits(count)) {
+    uint32_t capacity = ring.capacity_for(count);
+    buffer.create(capacity);
+    ring.reset(capacity);
+  }
+  buffer.lock(ring.allocate(count), count, frame);
+}
+
+void check_basics() {
+  RingAllocator ring(1000);
+  CHECK(ring.capacity() == 0 && !ring.fits(1));
+  CHECK(ring.capacity_for(10) == 4096); // 1000 * 3 rounded up to a power of two
+
+  ring.reset(4096);
+  auto first = ring.allocate(1000);
+  CHECK(first.offset == 0 && first.discard); // A new buffer always starts with DISCARD
+  auto second = ring.allocate(1000);
+  CHECK(second.offset == 1000 && !second.discard);
+  auto third = ring.allocate(1000);
+  CHECK(third.offset == 2000 && !third.discard);
+  auto wrapped = ring.allocate(1500);
+  CHECK(wrapped.offset == 0 && wrapped.discard);
+  CHECK(ring.high_water() == 1500);
+  CHECK(!ring.fits(10)); // Three 1500 frames no longer fit in 4096
+
+  // Capacity follows the high-water mark, which survives a device reset
+  ring.invalidate();
+  CHECK(ring.capacity() == 0);
+  CHECK(ring.capacity_for(10) == 8192);
+  ring.reset(8192);
+  CHECK(ring.allocate(10).discard);
+}
+
+// A UI that grows for a while and then stays put: buffers are only recreated while it grows,
+// and a steady UI never locks over a range the previous frames still use
+void check_session() {
+  RingAllocator ring(5000);
+  FakeBuffer buffer;
+  std::mt19937 rng(7);
+
+  int frame = 0;
+  for (; frame < 200; ++frame) {
+    render(ring, buffer, 1000 + frame * 300 + rng() % 500, frame);
+  }
+  int creates_while_growing = buffer.creates;
+  CHECK(creates_while_growing <= 6);
+
+  for (; frame < 5000; ++frame) {
+    render(ring, buffer, 20000 + rng() % 40000, frame);
+  }
+  CHECK(buffer.creates == creates_while_growing);
+  CHECK(buffer.appends > buffer.discards); // Most frames append without discarding
+
+  // Device reset: one recreation at the remembered size, then steady again
+  ring.invalidate();
+  buffer.written_by.clear();
+  for (int i = 0; i < 100; ++i, ++frame) {
+    render(ring, buffer, 20000 + rng() % 40000, frame);
+  }
+  CHECK(buffer.creates == creates_while_growing + 1);
+}
+
+} // namespace
+
+int main() {
+  check_basics();
+  check_session();
+  return 0;
+}
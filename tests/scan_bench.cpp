@@ -0,0 +1,59 @@
+#include "scan.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Throughput of each scanner path over a synthetic image with an x86-like byte mix, the
+// pattern only matching at the very end so every path reads the whole buffer
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+template<typename F>
+double best_ms(F &&f, int runs = 7) {
+  double best = 1e30;
+  for (int r = 0; r < runs; ++r) {
+    auto start = Clock::now();
+    f();
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    best = ms < best ? ms : best;
+  }
+  return best;
+}
+
+volatile const uint8_t *sink;
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t mb = argc > 1 ? static_cast<size_t>(atoi(argv[1])) : 32;
+  std::vector<uint8_t> data(mb * 1024 * 1024);
+
+  std::mt19937 rng(42);
+  static const uint8_t common[] = {0x00, 0xFF, 0x8B, 0x48, 0x89, 0xCC, 0x0F, 0xE8, 0x24, 0x45};
+  for (auto &byte : data) {
+    byte = rng() % 4 ? common[rng() % sizeof(common)] : static_cast<uint8_t>(rng());
+  }
+  const uint8_t tail[] = {0x48, 0x8B, 0x0D, 0x11, 0x22, 0x33, 0x44, 0xE8, 0xAA, 0xBB, 0xCC, 0xDD, 0x85, 0xC0};
+  std::copy(std::begin(tail), std::end(tail), data.end() - sizeof(tail));
+
+  scan::Pattern pattern = scan::parse("48 8B 0D ? ? ? ? E8 ? ? ? ? 85 C0");
+  double size_mb = static_cast<double>(data.size()) / (1024.0 * 1024.0);
+  auto report = [&](const char *name, double ms) {
+    printf("%-22s %8.2f ms %9.0f MB/s\n", name, ms, size_mb / (ms / 1000.0));
+  };
+
+  printf("%zu MB, pattern of %zu bytes\n", mb, pattern.size());
+  report("scalar", best_ms([&] { sink = scan::find_scalar(data.data(), data.size(), pattern); }));
+  if (scan::has_sse2())
+    report("sse2", best_ms([&] { sink = scan::find_sse2(data.data(), data.size(), pattern); }));
+  if (scan::has_avx2())
+    report("avx2", best_ms([&] { sink = scan::find_avx2(data.data(), data.size(), pattern); }));
+
+  std::vector<scan::Pattern> many(32, pattern);
+  report("find_many x32, 1 thr",
+         best_ms([&] { scan::find_many(data.data(), data.size(), many, scan::Hits::First, 1); }, 3));
+  report("find_many x32", best_ms([&] { scan::find_many(data.data(), data.size(), many, scan::Hits::First); }, 3));
+  return 0;
+}
@@ -0,0 +1,133 @@
+#include "scan.hpp"
+#include "check.hpp"
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace scan::literals;
+
+namespace {
+
+// Reference: every masked byte compared at every position
+std::vector<size_t> naive_all(const std::vector<uint8_t> &data, const scan::Pattern &pattern) {
+  std::vector<size_t> hits;
+  if (pattern.empty() || data.size() < pattern.size())
+    return hits;
+  for (size_t i = 0; i + pattern.size() <= data.size(); ++i) {
+    bool match = true;
+    for (size_t j = 0; j < pattern.size() && match; ++j) {
+      match = !pattern.mask[j] || data[i + j] == pattern.bytes[j];
+    }
+    if (match)
+      hits.push_back(i);
+  }
+  return hits;
+}
+
+long offset_of(const std::vector<uint8_t> &data, const uint8_t *found) {
+  return found ? static_cast<long>(found - data.data()) : -1;
+}
+
+// Small alphabet so anchors hit often and candidates need verifying
+uint8_t random_byte(std::mt19937 &rng) {
+  static const uint8_t common[] = {0x00, 0xFF, 0x8B, 0x48, 0x89, 0xCC, 0xE8, 0x0F};
+  if (rng() % 4 != 0)
+    return common[rng() % sizeof(common)];
+  return static_cast<uint8_t>(rng());
+}
+
+std::string hex(uint8_t byte) {
+  static const char digits[] = "0123456789ABCDEF";
+  return {digits[byte >> 4], digits[byte & 0xF]};
+}
+
+// Pattern text for length bytes, copied from data at pos when it fits so it matches there
+std::string random_pattern(std::mt19937 &rng, const std::vector<uint8_t> &data, size_t length) {
+  bool from_data = data.size() >= length && rng() % 3 != 0;
+  size_t pos = from_data ? rng() % (data.size() - length + 1) : 0;
+
+  std::string text;
+  for (size_t j = 0; j < length; ++j) {
+    if (!text.empty())
+      text += ' ';
+    if (rng() % 4 == 0)
+      text += rng() % 2 ? "?" : "??";
+    else
+      text += hex(from_data ? data[pos + j] : random_byte(rng));
+  }
+  return text;
+}
+
+void check_single(std::mt19937 &rng, int cases) {
+  for (int c = 0; c < cases; ++c) {
+    std::vector<uint8_t> data(rng() % 5000);
+    for (auto &byte : data) {
+      byte = random_byte(rng);
+    }
+
+    scan::Pattern pattern = scan::parse(random_pattern(rng, data, 1 + rng() % 24).c_str());
+    auto all = naive_all(data, pattern);
+    long expected = all.empty() ? -1 : static_cast<long>(all.front());
+
+    CHECK(offset_of(data, scan::find_scalar(data.data(), data.size(), pattern)) == expected);
+    if (scan::has_sse2())
+      CHECK(offset_of(data, scan::find_sse2(data.data(), data.size(), pattern)) == expected);
+    if (scan::has_avx2())
+      CHECK(offset_of(data, scan::find_avx2(data.data(), data.size(), pattern)) == expected);
+    CHECK(offset_of(data, scan::find(data.data(), data.size(), pattern)) == expected);
+  }
+}
+
+// Several MB, so matches land on and across chunk boundaries
+void check_many(std::mt19937 &rng) {
+  std::vector<uint8_t> data(3 * 1024 * 1024 + 123);
+  for (auto &byte : data) {
+    byte = random_byte(rng);
+  }
+
+  std::vector<scan::Pattern> patterns;
+  for (int p = 0; p < 24; ++p) {
+    patterns.push_back(scan::parse(random_pattern(rng, data, 2 + rng() % 12).c_str()));
+  }
+  // Straddles the first chunk boundary
+  std::string boundary;
+  for (size_t j = 256 * 1024 - 3; j < 256 * 1024 + 5; ++j) {
+    boundary += hex(data[j]) + " ";
+  }
+  patterns.push_back(scan::parse(boundary.c_str()));
+
+  for (unsigned threads : {1u, 4u, 0u}) {
+    auto all = scan::find_many(data.data(), data.size(), patterns, scan::Hits::All, threads);
+    auto first = scan::find_many(data.data(), data.size(), patterns, scan::Hits::First, threads);
+    CHECK(all.size() == patterns.size() && first.size() == patterns.size());
+
+    for (size_t p = 0; p < patterns.size(); ++p) {
+      auto expected = naive_all(data, patterns[p]);
+      CHECK(all[p] == expected);
+      CHECK(first[p].size() == (expected.empty() ? 0u : 1u));
+      if (!expected.empty())
+        CHECK(first[p].front() == expected.front());
+    }
+  }
+}
+
+void check_fixed() {
+  std::vector<uint8_t> data(4096, 0xCC);
+  const uint8_t code[] = {0x48, 0x8B, 0x05, 0x11, 0x22, 0x33, 0x44, 0x89};
+  std::copy(std::begin(code), std::end(code), data.begin() + 3000);
+
+  constexpr auto sig = "48 8B 05 ? ? ? ? 89"_sig;
+  CHECK(offset_of(data, scan::find(data.data(), data.size(), sig)) == 3000);
+  CHECK(offset_of(data, scan::find(data.data(), 3000 + 7, sig)) == -1);
+}
+
+} // namespace
+
+int main() {
+  std::mt19937 rng(1234);
+  check_single(rng, 3000);
+  check_many(rng);
+  check_fixed();
+  printf("scan: sse2=%d avx2=%d, all paths match the reference\n", scan::has_sse2(), scan::has_avx2());
+  return 0;
+}
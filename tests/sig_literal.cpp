@@ -0,0 +1,28 @@
+#include "scan.hpp"
+#include "check.hpp"
+
+using namespace scan::literals;
+
+// Parsed at compile time, matching the runtime parser byte for byte
+constexpr auto SIG = "48 8B ?? 05 ? ? ? ? 89"_sig;
+static_assert(SIG.size() == 9);
+static_assert(SIG.bytes[0] == 0x48 && SIG.mask[0] == 0xFF);
+static_assert(SIG.mask[2] == 0 && SIG.mask[4] == 0);
+static_assert(SIG.bytes[3] == 0x05);
+
+#ifdef SIG_LITERAL_MALFORMED
+// Odd digit count, must fail constant evaluation
+constexpr auto BAD = "48 8B 5"_sig;
+#endif
+
+int main() {
+  scan::Pattern parsed = scan::parse("48 8B ?? 05 ? ? ? ? 89");
+  CHECK(parsed.size() == SIG.size());
+  for (size_t i = 0; i < SIG.size(); ++i) {
+    CHECK(parsed.bytes[i] == SIG.bytes[i]);
+    CHECK(parsed.mask[i] == SIG.mask[i]);
+  }
+  CHECK(parsed.anchor == SIG.anchor);
+  CHECK(parsed.second == SIG.second);
+  return 0;
+}